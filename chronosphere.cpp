@@ -3,8 +3,14 @@
 #include <vector>
 #include <cassert>
 #include <string>
+#include <algorithm>
 #include "parser_helper.h"
 #include "graph.h"
+#include "thread_pool.h"
+#include "lib_cache.h"
+#include "lut.h"
+#include "paths.h"
+#include "ops.h"
 
 extern std::unordered_map <string, LibParserCellInfo> Cells;
 extern std::unordered_map <string, VerParserPinInfo> Pins;
@@ -13,8 +19,45 @@ extern std::unordered_map <string, SpefNet> SpefNets;
 
 int main(int args, char** argv) {
 
-  if (args != 2) {
-    cout << "Usage: " << argv[0] << " <.tau2015> <.timing> <.ops> <output_file>" << endl ;
+  vector<string> files;
+  vector<string> corners;  // library, spef of every extra corner
+  unsigned int numPaths = 0;
+  bool lazy = false;
+
+  // Options come first, then the input files
+  for ( int i = 1; i < args; i++ ) {
+
+    string arg = argv[i];
+
+    if ( arg == "-threads" && i + 1 < args )
+      NumThreads = std::max( 1, atoi(argv[++i]) );
+    else if ( arg == "-no_lib_cache" )
+      UseLibCache = false;
+    else if ( arg == "-spef_stream" )
+      SpefStreaming = true;
+    else if ( arg == "-delay_cache" && i + 2 < args ) {
+      UseDelayCache = true;
+      DelayCacheSlewQuantum = std::max( 0.0, atof(argv[++i]) );
+      DelayCacheLoadQuantum = std::max( 0.0, atof(argv[++i]) );
+    }
+    else if ( arg == "-epsilon" && i + 1 < args )
+      TimingEpsilon = std::max( 0.0, atof(argv[++i]) );
+    else if ( arg == "-lazy" )
+      lazy = true;
+    else if ( arg == "-report_paths" && i + 1 < args )
+      numPaths = std::max( 0, atoi(argv[++i]) );
+    else if ( arg == "-corner" && i + 2 < args ) {
+      corners.push_back(argv[++i]);
+      corners.push_back(argv[++i]);
+    }
+    else
+      files.push_back(arg);
+
+  }
+
+  if (files.empty()) {
+    cout << "Usage: " << argv[0] << " [-threads N] [-no_lib_cache] [-spef_stream] [-delay_cache <slew quantum> <load quantum>] [-epsilon <value>] [-lazy] [-report_paths K] [-corner <.lib> <.spef>]... <.tau2015> <.timing> <.ops> <output_file>" << endl ;
+    cout << "  -spef_stream frees the RC detail of every net once its sink delays are computed. It only saves memory, timing is the same." << endl ;
     exit(0) ;
   }
 
@@ -22,13 +65,13 @@ int main(int args, char** argv) {
 
 
   // Start parsing files
-  std::ifstream infile(argv[1]) ;
+  std::ifstream infile(files[0]) ;
   
   std::basic_string<char>::size_type index;
   std::string filename, libfile, vfile, speffile, base_path;
 
-  index = string(argv[1]).find_last_of("/");
-  base_path = string(argv[1]).substr(0,index);
+  index = files[0].find_last_of("/");
+  base_path = files[0].substr(0,index);
 
   // Get file paths from tau2015
   for ( int i = 0; i < 3; i++ ) {
@@ -53,9 +96,69 @@ int main(int args, char** argv) {
   result = wake_parser("spef", speffile);
   assert(result);
 
+  // Timing assertions for the ports
+  if (files.size() > 1) {
+    result = wake_parser("assertions", files[1]);
+    assert(result);
+  }
+
+  // Libraries and parasitics of the other corners
+  for (unsigned int i = 0; i < corners.size(); i += 2) {
+    result = load_corner(corners[i], corners[i + 1]);
+    assert(result);
+  }
+
   // Create the graph. Connect the pins
   result = create_graph();
   //print_graph();
-  result = find_nets_delay();
+
+  // Lazy timing leaves it to the queries to time what they ask about
+  if (lazy)
+    result = begin_lazy_timing();
+  else {
+    result = find_nets_delay();
+    result = bfs_on_graph_bwd();
+  }
+
+  // Worst slacks of every corner, the primary one first with its CPPR credits
+  if (!Corners.empty())
+    ensure_timing();
+
+  for (unsigned int k = 0; k <= Corners.size() && !Corners.empty(); k++) {
+
+    double worstLate = std::numeric_limits<double>::max();
+    double worstEarly = std::numeric_limits<double>::max();
+
+    for (PinId p = 0; p < PinTable.size(); p++) {
+      if (k == 0) {
+        worstLate = std::min(worstLate, report_slack(p, true));
+        worstEarly = std::min(worstEarly, report_slack(p, false));
+      }
+      else {
+        worstLate = std::min(worstLate, CornerPins[p * Corners.size() + k - 1].slack_late);
+        worstEarly = std::min(worstEarly, CornerPins[p * Corners.size() + k - 1].slack_early);
+      }
+    }
+
+    cout << "Corner " << k << ": worst late slack " << worstLate << ", worst early slack " << worstEarly << endl;
+  }
+
+  // Worst setup paths of the design
+  if (numPaths > 0)
+    print_paths(report_worst_paths(numPaths), true);
+
+  // Edits and queries, answers to the output file
+  if (files.size() > 2) {
+    result = run_ops(files[2], files.size() > 3 ? files[3] : "");
+    if (!result)
+      cout << "Error: Cannot read " << files[2] << endl;
+  }
+
+  if (UseDelayCache) {
+    uint64_t hits, misses;
+    delay_cache_stats(hits, misses);
+    cout << "Delay cache: slews rounded to " << DelayCacheSlewQuantum << " (library time unit), loads to "
+         << DelayCacheLoadQuantum << " (library capacitance unit): " << hits << " hits, " << misses << " misses" << endl;
+  }
 
 }
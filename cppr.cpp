@@ -0,0 +1,318 @@
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include "parser_helper.h"
+#include "graph.h"
+#include "cppr.h"
+
+ClockTree ClockNet;
+
+bool is_clock_pin( PinId p ) {
+
+  const VerParserPinInfo& pin = PinTable[p];
+  return pin.libPin != nullptr && pin.libPin->isClock && CellTable[pin.cell]->isSequential;
+
+}
+
+static unsigned int add_node( PinId pin, unsigned int parent ) {
+
+  unsigned int node = ClockNet.pins.size();
+
+  ClockNet.pins.push_back( pin );
+  ClockNet.parent.push_back( parent );
+  ClockNet.depth.push_back( parent == INVALID_ID ? 0 : ClockNet.depth[parent] + 1 );
+  ClockNet.credit.push_back( 0 );
+  ClockNet.nodeOf[pin] = node;
+
+  return node;
+
+}
+
+int build_clock_tree() {
+
+  ClockNet.clear();
+
+  PinId root = ClockPort.empty() ? INVALID_ID : PinNames.find( ClockPort );
+  if ( root == INVALID_ID )
+    return 0;
+
+  /* Pins that lead to a flip flop clock pin, fanouts first. The walk *
+   * below stays on them, so where the clock also drives data logic   *
+   * it does not follow it.                                           */
+  vector<char> feedsClock( PinTable.size(), 0 );
+
+  for ( auto it = LevelPins.rbegin(); it != LevelPins.rend(); it++ ) {
+
+    PinId p = *it;
+    feedsClock[p] = is_clock_pin( p );
+
+    for ( EdgeId e = FanoutBegin[p]; e < FanoutBegin[p + 1] && !feedsClock[p]; e++ )
+      if ( is_timing_edge( EdgeTable[e] ) && feedsClock[EdgeTable[e].toPin] )
+        feedsClock[p] = 1;
+  }
+
+  ClockNet.nodeOf.assign( PinTable.size(), INVALID_ID );
+  add_node( root, INVALID_ID );
+
+  /* Breadth first from the port. The children of a node are added *
+   * together, so they are the consecutive nodes childBegin[n] ..   *
+   * childBegin[n+1]-1.                                             */
+  vector<unsigned int> childBegin;
+
+  for ( unsigned int n = 0; n < ClockNet.pins.size(); n++ ) {
+
+    PinId p = ClockNet.pins[n];
+    childBegin.push_back( ClockNet.pins.size() );
+
+    /* Do not follow the flip flops into the data paths */
+    if ( n > 0 && is_clock_pin( p ) )
+      continue;
+
+    for ( EdgeId e = FanoutBegin[p]; e < FanoutBegin[p + 1]; e++ )
+      if ( is_timing_edge( EdgeTable[e] ) && feedsClock[EdgeTable[e].toPin] &&
+           ClockNet.nodeOf[EdgeTable[e].toPin] == INVALID_ID )
+        add_node( EdgeTable[e].toPin, n );
+  }
+
+  unsigned int numNodes = ClockNet.pins.size();
+  childBegin.push_back( numNodes );
+
+  /* Euler tour. A node is written when it is entered and again after *
+   * each of its children.                                            */
+  ClockNet.first.assign( numNodes, 0 );
+  ClockNet.euler.reserve( 2 * numNodes - 1 );
+
+  vector< std::pair<unsigned int, unsigned int> > stack;   // node, next child
+  stack.push_back( std::make_pair( 0u, childBegin[0] ) );
+  ClockNet.first[0] = 0;
+  ClockNet.euler.push_back( 0 );
+
+  while ( !stack.empty() ) {
+
+    unsigned int node = stack.back().first;
+    unsigned int child = stack.back().second;
+
+    if ( child == childBegin[node + 1] ) {
+      stack.pop_back();
+      if ( !stack.empty() )
+        ClockNet.euler.push_back( stack.back().first );
+      continue;
+    }
+
+    stack.back().second++;
+    ClockNet.first[child] = ClockNet.euler.size();
+    ClockNet.euler.push_back( child );
+    stack.push_back( std::make_pair( child, childBegin[child] ) );
+  }
+
+  /* Sparse table of the shallowest node over every power of two range */
+  unsigned int tourSize = ClockNet.euler.size();
+  ClockNet.sparse.push_back( ClockNet.euler );
+
+  for ( unsigned int k = 1; ( 1u << k ) <= tourSize; k++ ) {
+
+    const vector<unsigned int>& prev = ClockNet.sparse[k - 1];
+    vector<unsigned int> row( tourSize - ( 1u << k ) + 1 );
+
+    for ( unsigned int i = 0; i < row.size(); i++ ) {
+      unsigned int a = prev[i];
+      unsigned int b = prev[i + ( 1u << (k - 1) )];
+      row[i] = ( ClockNet.depth[a] <= ClockNet.depth[b] ) ? a : b;
+    }
+
+    ClockNet.sparse.push_back( row );
+  }
+
+  for ( unsigned int n = 0; n < numNodes; n++ )
+    update_clock_credit( ClockNet.pins[n] );
+
+#ifdef DEBUG
+  /* Every flip flop against the one before it. Their clock paths meet *
+   * at the common node, whose spread must come back as the credit.   */
+  unsigned int prev = INVALID_ID, pairs = 0, credited = 0;
+
+  for ( unsigned int n = 0; n < numNodes; n++ ) {
+
+    if ( !is_clock_pin( ClockNet.pins[n] ) )
+      continue;
+
+    if ( prev != INVALID_ID ) {
+
+      unsigned int a = prev, b = n;
+      while ( ClockNet.depth[a] > ClockNet.depth[b] ) a = ClockNet.parent[a];
+      while ( ClockNet.depth[b] > ClockNet.depth[a] ) b = ClockNet.parent[b];
+      while ( a != b ) { a = ClockNet.parent[a]; b = ClockNet.parent[b]; }
+
+      const VerParserPinInfo& common = PinTable[ClockNet.pins[a]];
+      double credit = cppr_credit( ClockNet.pins[prev], ClockNet.pins[n] );
+
+      assert( clock_lca( prev, n ) == a );
+      assert( credit == ClockNet.credit[a] );
+      assert( !is_timed( common ) || common.at_r_late == common.at_r_early || credit > 0 );
+
+      pairs++;
+      credited += ( credit > 0 );
+    }
+
+    prev = n;
+  }
+
+  cout << "CPPR: " << credited << " of " << pairs << " flip flop pairs have a credit" << endl;
+#endif
+
+  return 1;
+
+}
+
+unsigned int clock_lca( unsigned int a, unsigned int b ) {
+
+  unsigned int l = ClockNet.first[a];
+  unsigned int r = ClockNet.first[b];
+
+  if ( l > r )
+    std::swap( l, r );
+
+  unsigned int k = 31 - __builtin_clz( r - l + 1 );
+  unsigned int x = ClockNet.sparse[k][l];
+  unsigned int y = ClockNet.sparse[k][r - ( 1u << k ) + 1];
+
+  return ( ClockNet.depth[x] <= ClockNet.depth[y] ) ? x : y;
+
+}
+
+double cppr_credit( PinId launchClock, PinId captureClock ) {
+
+  if ( launchClock == INVALID_ID || captureClock == INVALID_ID || ClockNet.nodeOf.empty() )
+    return 0;
+
+  unsigned int a = ClockNet.nodeOf[launchClock];
+  unsigned int b = ClockNet.nodeOf[captureClock];
+
+  if ( a == INVALID_ID || b == INVALID_ID )
+    return 0;
+
+  return ClockNet.credit[clock_lca( a, b )];
+
+}
+
+void update_clock_credit( PinId pin ) {
+
+  if ( pin >= ClockNet.nodeOf.size() || ClockNet.nodeOf[pin] == INVALID_ID )
+    return;
+
+  const VerParserPinInfo& p = PinTable[pin];
+  ClockNet.credit[ClockNet.nodeOf[pin]] = is_timed( p ) ? p.at_r_late - p.at_r_early : 0;
+
+}
+
+static double arrival( const VerParserPinInfo& pin, bool rise, bool late ) {
+
+  if ( late )
+    return rise ? pin.at_r_late : pin.at_f_late;
+  return rise ? pin.at_r_early : pin.at_f_early;
+
+}
+
+/* Walk the worst path back from the pin. At every pin take the fanin *
+ * edge that gives the worst arrival of the current transition.       */
+PinId launching_clock( PinId pin, bool rise, bool late ) {
+
+  while ( true ) {
+
+    EdgeId worst = INVALID_ID;
+    bool worstRise = rise;
+    double worstValue = 0;
+
+    for ( EdgeId i = FaninBegin[pin]; i < FaninBegin[pin + 1]; i++ ) {
+
+      const NetsInfo& edge = EdgeTable[FaninEdges[i]];
+      const VerParserPinInfo& prev = PinTable[edge.fromPin];
+
+      if ( !is_timing_edge( edge ) || !is_timed( prev ) )
+        continue;
+
+      bool prevRise = rise;
+      double delay = edge.delay;
+
+      if ( edge.net == INVALID_ID ) {
+
+        TimingSense sense = ArcTable[edge.arc]->sense;
+
+        if ( late )
+          delay = rise ? edge.dr_LATE : edge.df_LATE;
+        else
+          delay = rise ? edge.dr_EARLY : edge.df_EARLY;
+
+        if ( sense == NEGATIVE_UNATE )
+          prevRise = !rise;
+        else if ( sense == NON_UNATE )
+          prevRise = late ? prev.at_r_late >= prev.at_f_late : prev.at_r_early <= prev.at_f_early;
+      }
+
+      double value = arrival( prev, prevRise, late ) + delay;
+
+      if ( worst == INVALID_ID || ( late ? value > worstValue : value < worstValue ) ) {
+        worst = FaninEdges[i];
+        worstRise = prevRise;
+        worstValue = value;
+      }
+    }
+
+    /* The path starts at a primary input */
+    if ( worst == INVALID_ID )
+      return INVALID_ID;
+
+    PinId prev = EdgeTable[worst].fromPin;
+
+    /* Or at the clock pin of a flip flop */
+    if ( EdgeTable[worst].net == INVALID_ID && is_clock_pin( prev ) )
+      return prev;
+
+    pin = prev;
+    rise = worstRise;
+  }
+
+}
+
+/* Only the data pins of flip flops have the clock as their required time */
+static bool captures_data( PinId pin ) {
+
+  const VerParserPinInfo& p = PinTable[pin];
+  return p.isInput && p.cell != INVALID_ID && CellTable[p.cell]->isSequential && !is_clock_pin( pin );
+
+}
+
+double path_credit( PinId start, PinId endpoint ) {
+
+  if ( start == INVALID_ID || !is_clock_pin( start ) || !captures_data( endpoint ) )
+    return 0;
+
+  return cppr_credit( start, InstanceClock[endpoint] );
+
+}
+
+double cppr_slack( PinId pin, bool rise, bool late ) {
+
+  const VerParserPinInfo& p = PinTable[pin];
+  double at = arrival( p, rise, late );
+  double rat;
+
+  if ( late )
+    rat = rise ? p.rat_r_late : p.rat_f_late;
+  else
+    rat = rise ? p.rat_r_early : p.rat_f_early;
+
+  /* Untimed and unconstrained pins are at +-max */
+  if ( !is_timed( p ) || std::fabs( rat ) == std::numeric_limits<double>::max() )
+    return std::numeric_limits<double>::max();
+
+  double slack = late ? rat - at : at - rat;
+
+  if ( !captures_data( pin ) )
+    return slack;
+
+  return slack + path_credit( launching_clock( pin, rise, late ), pin );
+
+}
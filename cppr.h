@@ -0,0 +1,75 @@
+#ifndef _CPPR_H
+#define _CPPR_H
+
+#include "graph.h"
+
+/* Clock network as a tree rooted at the clock port, for clock pessimism *
+ * removal. Its nodes are the pins of the clock network and its leaves   *
+ * the clock pins of the flip flops. Pins that lead to no flip flop      *
+ * clock pin, such as data logic the clock port also drives, are left    *
+ * out. Where the clock reconverges, the first path found to a pin wins. */
+struct ClockTree {
+
+  vector<PinId> pins;                 // by node, the root is node 0
+  vector<unsigned int> parent;        // by node, INVALID_ID for the root
+  vector<unsigned int> depth;         // by node
+  vector<double> credit;              // by node, late - early rising arrival
+  vector<unsigned int> nodeOf;        // by PinId, INVALID_ID off the tree
+
+  /* Euler tour of the tree and a sparse table over the depths along    *
+   * it. The common ancestor of two nodes is the shallowest node of the *
+   * tour between their first visits, found with two table lookups.    */
+  vector<unsigned int> euler;                 // nodes in tour order
+  vector<unsigned int> first;                 // by node, first position in the tour
+  vector< vector<unsigned int> > sparse;      // sparse[k][i]: shallowest of euler[i .. i+2^k-1]
+
+  void clear() {
+    pins.clear();
+    parent.clear();
+    depth.clear();
+    credit.clear();
+    nodeOf.clear();
+    euler.clear();
+    first.clear();
+    sparse.clear();
+  }
+
+};
+
+extern ClockTree ClockNet;
+
+/* Extract the tree under ClockPort and build the lookup tables. *
+ * Needs the arrivals of find_nets_delay for the credits.         */
+int build_clock_tree();
+
+/* Lowest common ancestor of two nodes, constant time */
+unsigned int clock_lca( unsigned int a, unsigned int b );
+
+/* Clock pin of a flip flop, where the clock tree ends */
+bool is_clock_pin( PinId pin );
+
+/* Pessimism shared by the clock paths to two flip flop clock pins: *
+ * the late - early spread at their common point. Constant time,    *
+ * 0 if either pin is off the tree.                                 */
+double cppr_credit( PinId launchClock, PinId captureClock );
+
+/* The arrival of a clock tree pin changed. Only the credit of its own *
+ * node depends on it; the tables stay as they are.                    */
+void update_clock_credit( PinId pin );
+
+/* Clock pin of the flip flop that launches the worst late (or early) *
+ * path into a transition of a pin, INVALID_ID if it starts at a      *
+ * primary input.                                                     */
+PinId launching_clock( PinId pin, bool rise, bool late );
+
+/* Credit of a path from start to endpoint. Only paths from a flip flop *
+ * clock pin to a flip flop data pin, which is checked against a clock, *
+ * get any.                                                             */
+double path_credit( PinId start, PinId endpoint );
+
+/* Slack of one transition of a pin, rat - at when late and at - rat  *
+ * when early, with the credit of its worst path added. +max if the   *
+ * pin has no arrival or no required time.                            */
+double cppr_slack( PinId pin, bool rise, bool late );
+
+#endif
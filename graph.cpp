@@ -3,10 +3,16 @@
 #include <vector>
 #include <cassert>
 #include <string>
+#include <cmath>
 #include <unistd.h>
 #include <algorithm>
 #include "parser_helper.h"
+#include "interner.h"
 #include "graph.h"
+#include "thread_pool.h"
+#include "cppr.h"
+#include "rc_tree.h"
+#include "lut.h"
 
 /* Hash tables */
 extern std::unordered_map <string, LibParserCellInfo> Cells;
@@ -15,96 +21,628 @@ extern std::unordered_map <string, NetParserInfo> NetsHelper;
 extern std::unordered_map <string, SpefNet> SpefNets;
 std::unordered_map <string, pi_values> PIs;
 std::unordered_map <string, po_values> POs;
-std::unordered_map <string, NetsInfo> Nets;
 
-/* Create Graph and Nets hash table. */
-int create_graph() {
+/* Id tables */
+NameInterner PinNames;
+NameInterner NetNames;
+NameInterner CellNames;
+vector<VerParserPinInfo> PinTable;
+vector<GraphNet> NetTable;
+vector<NetsInfo> EdgeTable;
+vector<LibParserCellInfo*> CellTable;
+vector<LibParserTimingInfo*> ArcTable;
+vector<PinId> PrimaryInputs;
+vector<PinId> PrimaryOutputs;
+vector<PinId> InstanceClock;
+
+/* By PinId, the setup and hold checks of a flip flop data pin against *
+ * its clock pin, INVALID_ID if the library has none                   */
+static vector<ArcId> SetupArc;
+static vector<ArcId> HoldArc;
+
+vector<EdgeId> FanoutBegin;
+vector<EdgeId> FaninBegin;
+vector<EdgeId> FaninEdges;
+vector<unsigned int> PinLevel;
+vector<PinId> LevelPins;
+vector<PinId> LevelBegin;
+vector<Corner> Corners;
+vector<CornerTiming> CornerPins;
+vector<CornerDelay> CornerEdges;
+
+/* First ArcId of every cell. The arcs of a cell are consecutive */
+static vector<ArcId> CellArcBegin;
+
+/* Where the values of a corner live. The primary corner is in the  *
+ * pin, edge and net tables, the extra ones in the corner tables.   *
+ * The passes are written against these and instantiated for both, *
+ * so the primary corner runs the same code it did on its own.      */
+struct PrimaryCorner {
+
+  VerParserPinInfo& timing( PinId p ) const { return PinTable[p]; }
+  NetsInfo& delays( EdgeId e ) const { return EdgeTable[e]; }
+  const LibParserTimingInfo& arc( ArcId a ) const { return *ArcTable[a]; }
+  const ArcLUT& lut( ArcId a ) const { return ArcLUTs[a]; }
+  SpefNet* spef( NetId n ) const { return NetTable[n].spef; }
+  double& load( NetId n ) const { return NetTable[n].load; }
+  const LibParserPinInfo* lib_pin( PinId p ) const { return PinTable[p].libPin; }
+
+};
+
+struct ExtraCorner {
+
+  unsigned int k;
+
+  ExtraCorner ( unsigned int corner ) : k (corner) {}
+
+  CornerTiming& timing( PinId p ) const { return CornerPins[p * Corners.size() + k]; }
+  CornerDelay& delays( EdgeId e ) const { return CornerEdges[e * Corners.size() + k]; }
+  const LibParserTimingInfo& arc( ArcId a ) const { return *Corners[k].arcTable[a]; }
+  const ArcLUT& lut( ArcId a ) const { return CornerLUTs[k][a]; }
+  SpefNet* spef( NetId n ) const { return Corners[k].spef[n]; }
+  double& load( NetId n ) const { return Corners[k].load[n]; }
+
+  const LibParserPinInfo* lib_pin( PinId p ) const {
+    const VerParserPinInfo& pin = PinTable[p];
+    return ( pin.cell == INVALID_ID ) ? nullptr : Corners[k].cellTable[pin.cell]->find_pin( pin.pinName );
+  }
 
-  /* Iterate through all nets and create connections on Pins hash table * 
-   * Also make Nets hash table. This will be our primary.               */
-  for ( auto it = NetsHelper.begin(); it != NetsHelper.end(); ++it ) {
-    
-    string key = (it->second).output.instance_name + (it->second).output.pinName;
-    string NetsKey;
-    NetPin newPin;
+};
 
-    /* Store primary inputs and outputs and connect them *
-     * to their corresponding pins.                      */
-    if ( (it->second).isPrimaryOut ) {
+/* Give ids to the library cells and their timing arcs */
+static void index_library() {
 
-      /* Set values */
-      POs[it->first].linkedBy = (it->second).output;
-      POs[it->first].tr_r_early = std::numeric_limits<double>::max();
-      POs[it->first].tr_f_early = std::numeric_limits<double>::max();
-      POs[it->first].tr_r_late = std::numeric_limits<double>::min();
-      POs[it->first].tr_f_late = std::numeric_limits<double>::min();
+  CellNames.clear();
+  CellTable.clear();
+  ArcTable.clear();
+  CellArcBegin.clear();
+
+  for ( auto it = Cells.begin(); it != Cells.end(); ++it ) {
+
+    CellNames.intern( it->first );
+    CellTable.push_back( &it->second );
+    CellArcBegin.push_back( ArcTable.size() );
+
+    for ( auto a = (it->second).timingArcs.begin(); a != (it->second).timingArcs.end(); a++ )
+      ArcTable.push_back( &*a );
+  }
+
+}
+
+/* Timing arc of a cell from one pin to another, INVALID_ID if there is none */
+static ArcId find_arc( CellId cell, const string& fromPin, const string& toPin ) {
+
+  if ( cell == INVALID_ID )
+    return INVALID_ID;
+
+  const LibParserCellInfo& info = *CellTable[cell];
+  auto from = info.arcsFrom.find( fromPin );
+
+  if ( from == info.arcsFrom.end() )
+    return INVALID_ID;
+
+  for ( auto i = from->second.begin(); i != from->second.end(); i++ )
+    if ( info.timingArcs[*i].toPin == toPin )
+      return CellArcBegin[cell] + *i;
+
+  return INVALID_ID;
+
+}
+
+/* Check arc of a given timing type ("setup" or "hold") from the *
+ * clock pin of a flip flop to one of its data pins                */
+static ArcId check_arc( PinId p, PinId clock, const string& type ) {
+
+  CellId cell = PinTable[p].cell;
+  const LibParserCellInfo& info = *CellTable[cell];
+  auto from = info.arcsFrom.find( PinTable[clock].pinName );
+
+  if ( from == info.arcsFrom.end() )
+    return INVALID_ID;
+
+  for ( auto i = from->second.begin(); i != from->second.end(); i++ ) {
+    const LibParserTimingInfo& arc = info.timingArcs[*i];
+    if ( arc.toPin == PinTable[p].pinName && arc.timingType.compare( 0, type.size(), type ) == 0 )
+      return CellArcBegin[cell] + *i;
+  }
+
+  return INVALID_ID;
+
+}
+
+/* Setup and hold checks of a pin, found again when its cell changes */
+static void resolve_checks( PinId p ) {
+
+  PinId clock = InstanceClock[p];
+
+  SetupArc[p] = HoldArc[p] = INVALID_ID;
+
+  if ( clock == INVALID_ID || clock == p || !PinTable[p].isInput )
+    return;
+
+  SetupArc[p] = check_arc( p, clock, "setup" );
+  HoldArc[p] = check_arc( p, clock, "hold" );
+
+}
+
+/* Resolve the pin a NetPin refers to. Ports are not in the *
+ * Pins hash table, they get their entry here.              */
+static PinId pin_id( NetPin& p ) {
+
+  PinId id = PinNames.intern( p.instance_name + p.pinName );
+
+  if ( id == PinTable.size() )
+    PinTable.emplace_back();
+
+  VerParserPinInfo& pin = PinTable[id];
+  if ( pin.pinName.empty() ) {
+    pin.instance_name = p.instance_name;
+    pin.pinName = p.pinName;
+  }
+
+  if ( !p.cellType.empty() ) {
+    pin.cell = CellNames.find( p.cellType );
+    pin.libPin = ( pin.cell == INVALID_ID ) ? nullptr : CellTable[pin.cell]->find_pin( pin.pinName );
+  }
+
+  p.pin = id;
+  return id;
+
+}
+
+/* Edges are appended in the order they are found and sorted by build_csr */
+static EdgeId add_edge( PinId from, PinId to, NetId net, ArcId arc ) {
+
+  EdgeId e = EdgeTable.size();
+
+  EdgeTable.emplace_back();
+  EdgeTable[e].fromPin = from;
+  EdgeTable[e].toPin = to;
+  EdgeTable[e].net = net;
+  EdgeTable[e].arc = arc;
+
+  return e;
+
+}
+
+/* Sort EdgeTable by source pin (keeping the order edges were added in) *
+ * and build the fanout and fanin indices.                              */
+static void build_csr() {
+
+  PinId numPins = PinTable.size();
+  EdgeId numEdges = EdgeTable.size();
+
+  FanoutBegin.assign( numPins + 1, 0 );
+  FaninBegin.assign( numPins + 1, 0 );
+
+  for ( EdgeId e = 0; e < numEdges; e++ ) {
+    FanoutBegin[EdgeTable[e].fromPin + 1]++;
+    FaninBegin[EdgeTable[e].toPin + 1]++;
+  }
+
+  for ( PinId p = 0; p < numPins; p++ ) {
+    FanoutBegin[p + 1] += FanoutBegin[p];
+    FaninBegin[p + 1] += FaninBegin[p];
+  }
+
+  vector<NetsInfo> sorted( numEdges );
+  vector<EdgeId> newId( numEdges );
+  vector<EdgeId> fill( FanoutBegin.begin(), FanoutBegin.end() - 1 );
+
+  for ( EdgeId e = 0; e < numEdges; e++ ) {
+    newId[e] = fill[EdgeTable[e].fromPin]++;
+    sorted[newId[e]] = EdgeTable[e];
+  }
+
+  FaninEdges.resize( numEdges );
+  fill.assign( FaninBegin.begin(), FaninBegin.end() - 1 );
+
+  for ( EdgeId e = 0; e < numEdges; e++ )
+    FaninEdges[fill[EdgeTable[e].toPin]++] = newId[e];
 
-      newPin.pinName = it->first;
-      newPin.instance_name.clear();
-      Pins[key].linksTo.push_back( newPin );
+  EdgeTable.swap( sorted );
 
-      /* Store primary outputs to Nets hash table */
-      NetsKey = it->first; // Net name, output
-      Nets[NetsKey].netName = NetsKey;
-      Nets[NetsKey].fromPin = newPin;
+}
+
+/* Wire delay of every sink edge of a net, from the delays cached in its *
+ * spef net when it was loaded. Sinks the spef file does not list get 0. */
+template <class CORNER>
+static void update_net_delays( const CORNER& corner, NetId net ) {
+
+  PinId driver = NetTable[net].driver;
+  if ( driver == INVALID_ID )
+    return;
+
+  for ( EdgeId e = FanoutBegin[driver]; e < FanoutBegin[driver + 1]; e++ )
+    if ( EdgeTable[e].net == net )
+      corner.delays( e ).delay = 0;
+
+  if ( corner.spef( net ) == nullptr )
+    return;
+
+  /* Cell pins are named instance + pin, ports by their own name */
+  const vector<SpefSinkDelay>& sinkDelays = corner.spef( net )->sinkDelays;
+
+  for ( auto j = sinkDelays.begin(); j != sinkDelays.end(); j++ ) {
+
+    PinId sink = PinNames.find( j->nodeName.n1 + j->nodeName.n2 );
+    if ( sink == INVALID_ID )
+      continue;
+
+    for ( EdgeId i = FaninBegin[sink]; i < FaninBegin[sink + 1]; i++ )
+      if ( EdgeTable[FaninEdges[i]].net == net )
+        corner.delays( FaninEdges[i] ).delay = j->delay;
+  }
+
+}
+
+/* Load a net puts on its driver: C is the sum of the caps of all the *
+ * pins it is linked to, plus the lumped cap of the wire.              */
+template <class CORNER>
+static void update_net_load( const CORNER& corner, NetId net ) {
+
+  double total_capacitance = 0;
+  PinId driver = NetTable[net].driver;
+
+  if ( driver != INVALID_ID )
+    for ( EdgeId e = FanoutBegin[driver]; e < FanoutBegin[driver + 1]; e++ ) {
 
+      /* If there is no cell, then we are looking at a net that connects an primary output */
+      const LibParserPinInfo* sink = corner.lib_pin( EdgeTable[e].toPin );
+      if ( EdgeTable[e].net != net || sink == nullptr )
+        continue;
 
+      total_capacitance += sink->capacitance;
     }
 
-    if ( (it->second).isPrimaryIn ) {
+  if ( corner.spef( net ) != nullptr )
+    total_capacitance += corner.spef( net )->netLumpedCap;
+
+  corner.load( net ) = total_capacitance;
+
+}
+
+/* Wire delays and load of a net at every corner */
+static void update_net( NetId net ) {
+
+  update_net_delays( PrimaryCorner(), net );
+  update_net_load( PrimaryCorner(), net );
+
+  for ( unsigned int k = 0; k < Corners.size(); k++ ) {
+    update_net_delays( ExtraCorner( k ), net );
+    update_net_load( ExtraCorner( k ), net );
+  }
+
+}
+
+int load_corner( const string& libFile, const string& spefFile ) {
+
+  Corners.emplace_back();
+  Corner& corner = Corners.back();
+
+  /* The parsers fill the global tables, so lend them the corner's */
+  Cells.swap( corner.cells );
+  int result = wake_parser( "lib", libFile );
+  Cells.swap( corner.cells );
+
+  SpefNets.swap( corner.spefNets );
+  result = result && wake_parser( "spef", spefFile );
+  SpefNets.swap( corner.spefNets );
+
+  return result;
+
+}
+
+/* Cells, arcs and nets of every extra corner by the ids of the *
+ * primary one. Anything a corner's files do not have keeps its *
+ * primary timing.                                              */
+static void index_corners() {
+
+  CornerLUTs.assign( Corners.size(), vector<ArcLUT>() );
+
+  for ( unsigned int k = 0; k < Corners.size(); k++ ) {
+
+    Corner& corner = Corners[k];
+
+    corner.cellTable.assign( CellTable.begin(), CellTable.end() );
+    corner.arcTable.assign( ArcTable.begin(), ArcTable.end() );
+
+    for ( CellId c = 0; c < CellTable.size(); c++ ) {
+
+      auto it = corner.cells.find( CellNames.name(c) );
+      if ( it == corner.cells.end() ) {
+        cout << "Warning: Cell " << CellNames.name(c) << " is not in the library of corner " << k + 1 << endl;
+        continue;
+      }
+
+      LibParserCellInfo& info = it->second;
+      const vector<LibParserTimingInfo>& arcs = CellTable[c]->timingArcs;
 
-      PIs[it->first].linksTo = (it->second).inputs; // link primary inputs
-      for( std::vector<NetPin>::const_iterator i = (it->second).inputs.begin(); i != (it->second).inputs.end(); ++i) {
-        string key3 = i->instance_name + i->pinName;
+      corner.cellTable[c] = &info;
 
-        /* Store info on Nets hash table */
-        NetsKey = it->first + i->instance_name+ i->pinName; // Net name + Cell_instance name & net name of the next pin 
-        Nets[NetsKey].toPin = *i;
-        Nets[NetsKey].netName = it->first;
+      for ( unsigned int i = 0; i < arcs.size(); i++ ) {
 
-        /* Store info on Pins hash table */
-        newPin.pinName = it->first;
-        newPin.instance_name.clear();
-        Pins[key3].linkedBy.push_back(newPin);
+        auto from = info.arcsFrom.find( arcs[i].fromPin );
+        if ( from == info.arcsFrom.end() )
+          continue;
+
+        for ( auto j = from->second.begin(); j != from->second.end(); j++ )
+          if ( info.timingArcs[*j].toPin == arcs[i].toPin && info.timingArcs[*j].timingType == arcs[i].timingType )
+            corner.arcTable[CellArcBegin[c] + i] = &info.timingArcs[*j];
       }
+    }
 
+    pack_arc_luts( corner.arcTable, CornerLUTs[k] );
+
+    corner.spef.assign( NetTable.size(), nullptr );
+    corner.load.assign( NetTable.size(), 0.0 );
+
+    for ( NetId n = 0; n < NetTable.size(); n++ ) {
+      auto it = corner.spefNets.find( NetNames.name(n) );
+      if ( it != corner.spefNets.end() )
+        corner.spef[n] = &it->second;
     }
+  }
+
+  CornerPins.assign( PinTable.size() * Corners.size(), CornerTiming() );
+  CornerEdges.assign( EdgeTable.size() * Corners.size(), CornerDelay() );
+
+}
+
+/* Renumber the pins in level order, so that every level is a run of *
+ * consecutive pins and the passes go through PinTable, and through   *
+ * EdgeTable with it, front to back. Pins on loops go last. Nets are  *
+ * renumbered in the order of their drivers. Names follow the ids.    */
+static void renumber_graph() {
+
+  levelize();
+
+  PinId numPins = PinTable.size();
+  vector<PinId> newPin( numPins, INVALID_ID );
+  PinId next = 0;
+
+  for ( PinId i = 0; i < LevelPins.size(); i++ )
+    newPin[LevelPins[i]] = next++;
+
+  for ( PinId p = 0; p < numPins; p++ )
+    if ( newPin[p] == INVALID_ID )
+      newPin[p] = next++;
+
+  vector<NetId> nets( NetTable.size() );
+  for ( NetId n = 0; n < nets.size(); n++ )
+    nets[n] = n;
+
+  /* Nets without a driver go last */
+  std::stable_sort( nets.begin(), nets.end(), [&newPin] ( NetId a, NetId b ) {
+    PinId da = NetTable[a].driver, db = NetTable[b].driver;
+    return ( da == INVALID_ID ? INVALID_ID : newPin[da] ) < ( db == INVALID_ID ? INVALID_ID : newPin[db] );
+  } );
+
+  vector<NetId> newNet( NetTable.size() );
+  for ( NetId n = 0; n < nets.size(); n++ )
+    newNet[nets[n]] = n;
+
+  vector<VerParserPinInfo> pins( numPins );
+  for ( PinId p = 0; p < numPins; p++ ) {
+    pins[newPin[p]] = std::move( PinTable[p] );
+    if ( pins[newPin[p]].net != INVALID_ID )
+      pins[newPin[p]].net = newNet[pins[newPin[p]].net];
+  }
+  PinTable.swap( pins );
+
+  vector<GraphNet> table( NetTable.size() );
+  for ( NetId n = 0; n < table.size(); n++ ) {
+    table[newNet[n]] = NetTable[n];
+    if ( table[newNet[n]].driver != INVALID_ID )
+      table[newNet[n]].driver = newPin[NetTable[n].driver];
+  }
+  NetTable.swap( table );
+
+  for ( EdgeId e = 0; e < EdgeTable.size(); e++ ) {
+    EdgeTable[e].fromPin = newPin[EdgeTable[e].fromPin];
+    EdgeTable[e].toPin = newPin[EdgeTable[e].toPin];
+    if ( EdgeTable[e].net != INVALID_ID )
+      EdgeTable[e].net = newNet[EdgeTable[e].net];
+  }
+
+  PinNames.renumber( newPin );
+  NetNames.renumber( newNet );
+
+  /* Edges sorted by the new source pins */
+  build_csr();
+
+}
+
+/* Ports, the clock pin of every flip flop pin and its checks */
+static void index_sequential() {
+
+  PrimaryInputs.clear();
+  PrimaryOutputs.clear();
+
+  /* Ports, in the order of the PIs and POs hash tables. Assertions *
+   * for ports that are not in the netlist are dropped here.         */
+  for ( auto it = PIs.begin(); it != PIs.end(); ++it )
+    if ( PinNames.find( it->first ) != INVALID_ID )
+      PrimaryInputs.push_back( PinNames.find( it->first ) );
+
+  for ( auto it = POs.begin(); it != POs.end(); ++it )
+    if ( PinNames.find( it->first ) != INVALID_ID )
+      PrimaryOutputs.push_back( PinNames.find( it->first ) );
+
+  /* Clock pin of the flip flop every pin belongs to */
+  InstanceClock.assign( PinTable.size(), INVALID_ID );
+
+  for ( PinId p = 0; p < PinTable.size(); p++ ) {
+
+    const VerParserPinInfo& pin = PinTable[p];
+    if ( pin.cell == INVALID_ID || !CellTable[pin.cell]->isSequential )
+      continue;
+
+    const vector<LibParserPinInfo>& cellPins = CellTable[pin.cell]->pins;
+    for ( auto it = cellPins.begin(); it != cellPins.end(); it++ )
+      if ( it->isClock ) {
+        InstanceClock[p] = PinNames.find( pin.instance_name + it->name );
+        break;
+      }
+  }
+
+  SetupArc.assign( PinTable.size(), INVALID_ID );
+  HoldArc.assign( PinTable.size(), INVALID_ID );
+
+  for ( PinId p = 0; p < PinTable.size(); p++ )
+    resolve_checks( p );
+
+}
+
+/* Create Graph and the id tables. */
+int create_graph() {
+
+  index_library();
+  build_arc_luts();
+
+  /* Cell pins first. Their data moves out of the Pins hash table */
+  PinNames.reserve( Pins.size() + PIs.size() + POs.size() );
+  PinTable.reserve( Pins.size() );
+
+  for ( auto it = Pins.begin(); it != Pins.end(); ++it ) {
+    PinNames.intern( it->first );
+    PinTable.push_back( std::move(it->second) );
+  }
+  Pins.clear();
+
+  /* Iterate through all nets and connect the pins. Every driver -> sink *
+   * pair of a net and every in-cell connection becomes an edge.        */
+  for ( auto it = NetsHelper.begin(); it != NetsHelper.end(); ++it ) {
     
-    if ( !key.empty() ) {
-      Pins[key].linksTo.insert( Pins[key].linksTo.end(), (it->second).inputs.begin(), (it->second).inputs.end() );
-
-      for ( auto i = (it->second).inputs.begin(); i != (it->second).inputs.end(); i++) {
-        /* Store info on Nets hash table */
-        NetsKey = it->first + i->instance_name + i->pinName; // Net name + (Cell_instance name & net name) of the next pin 
-        Nets[NetsKey].toPin = *i;
-        Nets[NetsKey].netName = it->first;
+    NetParserInfo& info = it->second;
+    NetPin driver = info.output;
+
+    /* In-cell connection: from a cell input to the outputs it drives */
+    if ( info.isCellArc ) {
+
+      pin_id( driver );
+      for ( auto i = info.inputs.begin(); i != info.inputs.end(); i++ ) {
+        NetPin sink = *i;
+        pin_id( sink );
+        add_edge( driver.pin, sink.pin, INVALID_ID, find_arc( PinTable[driver.pin].cell, driver.pinName, sink.pinName ) );
       }
 
+      continue;
     }
 
-    /* To store linkedBy information, we need to iterate through every input item and store the output to them *
-     * Reminder: Since we create PIs and POs above, we make sure that they are not included in Pins table      */
-    for( std::vector<NetPin>::const_iterator i = (it->second).inputs.begin(); i != (it->second).inputs.end() && !(it->second).isPrimaryIn && !(it->second).isPrimaryOut; ++i) {
+    NetId net = NetNames.intern( it->first );
+    NetTable.resize( NetNames.size() );
 
-      string key2 = i->instance_name + i->pinName;
-      Pins[key2].linkedBy.insert(Pins[key2].linkedBy.end(), it->second.output);
+    auto spef = SpefNets.find( it->first );
+    NetTable[net].spef = ( spef == SpefNets.end() ) ? nullptr : &spef->second;
+    NetTable[net].isPrimaryIn = info.isPrimaryIn;
+    NetTable[net].isPrimaryOut = info.isPrimaryOut;
 
-      /* Store Nets fromPin info */
-      for ( auto i2 = Pins[key2].linkedBy.begin(); i2 != Pins[key2].linkedBy.end(); i2++) {
-        NetsKey = it->first + i->instance_name + i->pinName;
-        Nets[NetsKey].fromPin = *i2;
-        Nets[NetsKey].netName = it->first;
-      }
+    /* Primary inputs drive their net through a port named after it */
+    if ( info.isPrimaryIn ) {
+      driver = NetPin();
+      driver.pinName = it->first;
+      PIs[it->first].linksTo = info.inputs;
+    }
+
+    vector<NetPin> sinks = info.inputs;
+
+    /* Primary outputs are a sink named after the net */
+    if ( info.isPrimaryOut ) {
+
+      NetPin port;
+      port.pinName = it->first;
+      sinks.insert( sinks.begin(), port );
 
+      /* Set values */
+      POs[it->first].linkedBy = info.output;
+      POs[it->first].tr_r_early = std::numeric_limits<double>::max();
+      POs[it->first].tr_f_early = std::numeric_limits<double>::max();
+      POs[it->first].tr_r_late = std::numeric_limits<double>::lowest();
+      POs[it->first].tr_f_late = std::numeric_limits<double>::lowest();
+    }
+
+    /* Net without a driver */
+    if ( driver.pinName.empty() )
+      continue;
+
+    PinTable[pin_id( driver )].net = net;
+    NetTable[net].driver = driver.pin;
+
+    for ( auto i = sinks.begin(); i != sinks.end(); i++ ) {
+      PinTable[pin_id( *i )].net = net;
+      add_edge( driver.pin, i->pin, net, INVALID_ID );
     }
-   
 
   }
 
+  build_csr();
+  renumber_graph();
+  index_corners();
+
+  for ( NetId net = 0; net < NetTable.size(); net++ )
+    update_net( net );
+
+  index_sequential();
+
   return 1;
 
 }
 
+/* Assign topological levels with Kahn's algorithm, one frontier *
+ * per level. Returns the number of levels.                      */
+int levelize() {
+
+  PinId numPins = PinTable.size();
+  vector<unsigned int> pending( numPins, 0 );
+
+  PinLevel.assign( numPins, INVALID_ID );
+  LevelPins.clear();
+  LevelBegin.clear();
+  LevelPins.reserve( numPins );
+
+  /* Count the fanins every pin waits for */
+  for ( EdgeId e = 0; e < EdgeTable.size(); e++ )
+    if ( is_timing_edge( EdgeTable[e] ) )
+      pending[EdgeTable[e].toPin]++;
+
+  for ( PinId p = 0; p < numPins; p++ )
+    if ( pending[p] == 0 )
+      LevelPins.push_back( p );
+
+  unsigned int level = 0;
+  PinId begin = 0;
+
+  /* Release the fanout of the current level. A pin joins the *
+   * next level when its last fanin is done.                  */
+  while ( begin < LevelPins.size() ) {
+
+    PinId end = LevelPins.size();
+    LevelBegin.push_back( begin );
+
+    for ( PinId i = begin; i < end; i++ ) {
+
+      PinId p = LevelPins[i];
+      PinLevel[p] = level;
+
+      for ( EdgeId e = FanoutBegin[p]; e < FanoutBegin[p + 1]; e++ )
+        if ( is_timing_edge( EdgeTable[e] ) && --pending[EdgeTable[e].toPin] == 0 )
+          LevelPins.push_back( EdgeTable[e].toPin );
+    }
+
+    begin = end;
+    level++;
+  }
+
+  LevelBegin.push_back( LevelPins.size() );
+
+  if ( LevelPins.size() != numPins )
+    cout << "Warning: " << numPins - LevelPins.size() << " pins are on combinational loops and will not be timed." << endl;
+
+  return level;
+
+}
+
 /* Print graph to graphviz format, using BFS */
 int print_graph() {
 
@@ -112,13 +650,14 @@ int print_graph() {
   string Colors[] = {"aliceblue", "powderblue", "lightskyblue","deepskyblue", "cornflowerblue","royalblue", \
                      "darkslateblue", "lightblue", "mediumblue", "midnightblue", "navy", "navyblue", "skyblue"} ;
 
-  vector<NetPin> fwdLevel0;
+  vector<PinId> fwdLevel0;
   vector<string> Visited, Visited2;
   cout << "digraph fwd {" << endl ;
   cout << "graph [rankdir=LR,fontsize=10];" << endl;
   /* Create subgraphs */
-  for ( auto it = Pins.begin(); it != Pins.end(); ++it ) {
-    for ( std::vector<NetPin>::const_iterator j = (it->second).linksTo.begin(); j != (it->second).linksTo.end(); j++ ) {
+  for ( EdgeId e = 0; e < EdgeTable.size(); ++e ) {
+    const VerParserPinInfo* j = &PinTable[EdgeTable[e].toPin];
+    {
       /* For each instance name create subgraph. Stupid implementation maybe fix it later */
 
       if ( std::find(Visited.begin(), Visited.end(), j->instance_name) == Visited.end() && !j->instance_name.empty() ) {
@@ -176,19 +715,19 @@ int print_graph() {
     cout << "\t" << it->first << ";" << endl;
   cout << "}" << endl;
 
-  for ( auto it = PIs.begin(); it != PIs.end(); ++it ) {
-
-    fwdLevel0.insert( fwdLevel0.end(), (it->second).linksTo.begin(), (it->second).linksTo.end() );
+  for ( auto it = PrimaryInputs.begin(); it != PrimaryInputs.end(); ++it ) {
 
-    for ( std::vector<NetPin>::const_iterator j = (it->second).linksTo.begin(); j != (it->second).linksTo.end(); j++ ) {
-      cout << "\t" << it->first << "->" <<  j->instance_name + j->pinName << ";" << endl; 
-      cout << "\t" << j->instance_name + j->pinName << "[color=" << Colors[level] << ",style=filled,fontsize=10]" << endl;    
+    for ( EdgeId e = FanoutBegin[*it]; e < FanoutBegin[*it + 1]; e++ ) {
+      PinId j = EdgeTable[e].toPin;
+      fwdLevel0.push_back( j );
+      cout << "\t" << PinNames.name(*it) << "->" <<  PinNames.name(j) << ";" << endl; 
+      cout << "\t" << PinNames.name(j) << "[color=" << Colors[level] << ",style=filled,fontsize=10]" << endl;    
     }
   }
 
   bool isFinalLevel = false;
-  vector<NetPin> currLevel = fwdLevel0;
-  vector<NetPin> nextLevel;
+  vector<PinId> currLevel = fwdLevel0;
+  vector<PinId> nextLevel;
   nextLevel.clear();
   level++;
 
@@ -197,9 +736,9 @@ int print_graph() {
     isFinalLevel = true;
   
     /* Start iterating current level */
-    for (std::vector<NetPin>::const_iterator i = currLevel.begin(); i != currLevel.end(); ++i) {
+    for (std::vector<PinId>::const_iterator i = currLevel.begin(); i != currLevel.end(); ++i) {
 
-      string key =  i->instance_name + i->pinName;
+      const string& key =  PinNames.name(*i);
 
       /* Build next level. Check if pin is in visited list. */
       if ( std::find(Visited.begin(), Visited.end(), key) == Visited.end() ) {
@@ -208,16 +747,17 @@ int print_graph() {
         // Insert pin to visited
         Visited.insert(Visited.end(), key );
 
-        for ( std::vector<NetPin>::const_iterator j = Pins[key].linksTo.begin(); j != Pins[key].linksTo.end(); j++ )  {
+        for ( EdgeId e = FanoutBegin[*i]; e < FanoutBegin[*i + 1]; e++ )  {
+
+          PinId j = EdgeTable[e].toPin;
           
           /* Print outputs with red color */
-          if ( !j->instance_name.empty() )
-            cout << "\t" << j->instance_name + j->pinName << "[color=" << Colors[level % NUM_OF_COLORS] << ",style=filled,fontsize=10]" << endl;
+          if ( !PinTable[j].instance_name.empty() )
+            cout << "\t" << PinNames.name(j) << "[color=" << Colors[level % NUM_OF_COLORS] << ",style=filled,fontsize=10]" << endl;
 
-          cout << "\t" << key << "->" <<  j->instance_name + j->pinName << ";" << endl; 
+          cout << "\t" << key << "->" <<  PinNames.name(j) << ";" << endl; 
+          nextLevel.push_back( j );
         }
-    
-        nextLevel.insert( nextLevel.end(), Pins[key].linksTo.begin(), Pins[key].linksTo.end() );
       }
     }
 
@@ -256,353 +796,1501 @@ void search_indicies() {
 
 }
 
-double calculate_net_delay( string netName, string instance_name ) {
+/* Input: the output pin whose load we want */
+double calculate_fanout( PinId outPin ) {
 
-  double total_res = 0;
-  double total_cap = 0;
+  const VerParserPinInfo& pin = PinTable[outPin];
+  return ( pin.net == INVALID_ID ) ? 0 : NetTable[pin.net].load;
 
-  for ( auto j = SpefNets[netName].resistances.begin(); j != SpefNets[netName].resistances.end(); j++ ) {
+}
 
-    /* Maybe the net is input to two or more pins. We check this here */
-    if ( j->toNodeName.n1 == netName || j->toNodeName.n1 == instance_name ) {
 
-      total_cap += j->resistance;
-      /* Find next resistance */ 
-      for ( auto j2 = SpefNets[netName].capacitances.begin(); j2 != SpefNets[netName].capacitances.end(); j2++ )
-        if ( j2->nodeName.n1 == j->toNodeName.n1 && j2->nodeName.n2 == j->toNodeName.n2 ){
-          total_res += total_cap*j2->capacitance;
-          break;            
-      }
+/* Pin values before anything reached them: early at +max, late at -max */
+template <class TIMING>
+static void reset_timing( TIMING& pin ) {
 
-    }
-  }
+  pin.at_r_early = pin.at_f_early = std::numeric_limits<double>::max();
+  pin.at_r_late = pin.at_f_late = -std::numeric_limits<double>::max();
+  pin.tr_r_early = pin.tr_f_early = std::numeric_limits<double>::max();
+  pin.tr_r_late = pin.tr_f_late = -std::numeric_limits<double>::max();
 
-  return total_res;
 }
 
-/* Input: Next Pin key that is connected to the output pin we are connected to */
-double calculate_fanout( string nextPkey, string spefKey ) {
+/* Early values keep the minimum, late values the maximum */
+static inline void merge_early( double& value, double x ) {
+  if ( x < value )
+    value = x;
+}
 
-  double total_capacitance = 0;
+static inline void merge_late( double& value, double x ) {
+  if ( x > value )
+    value = x;
+}
 
-  /* C is the sum of all the nodes linked to, to the pin we are looking at */
-  for ( auto j2 = Pins[nextPkey].linksTo.begin(); j2 != Pins[nextPkey].linksTo.end(); j2++ ) {
+/* Same merges for a value other threads may merge into at the same *
+ * time. The compare and swap only retries while x still improves on *
+ * what is there, so the result does not depend on the order.        */
+static inline void atomic_merge_early( double& value, double x ) {
 
-    /* If cellType is empty, then we are looking at a net that connects an primary output */
-    if ( j2->cellType.empty() )
-    continue;
+  double current;
+  __atomic_load( &value, &current, __ATOMIC_RELAXED );
 
-    auto cellPin  = find_if( Cells[j2->cellType].pins.begin(), Cells[j2->cellType].pins.end(), findPinInfo( j2->pinName ) );             
-    total_capacitance += cellPin->capacitance;
-                      
-  }
+  while ( x < current &&
+          !__atomic_compare_exchange( &value, &current, &x, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+    ;
 
-  /* Also add the net capacitance */
-  return total_capacitance + SpefNets[spefKey].netLumpedCap ;
+}
+
+static inline void atomic_merge_late( double& value, double x ) {
+
+  double current;
+  __atomic_load( &value, &current, __ATOMIC_RELAXED );
+
+  while ( x > current &&
+          !__atomic_compare_exchange( &value, &current, &x, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+    ;
 
 }
 
+/* Arrival and slew one fanin edge gives a pin */
+struct TimingRecord {
 
-double BilinearInterpol ( double index1, double index2, LibParserLUT lut ) {
+  double at_r_early, at_f_early, at_r_late, at_f_late;
+  double tr_r_early, tr_f_early, tr_r_late, tr_f_late;
 
-  double result = 0;
-  int x1;
-  int x2;
-  int y1;
-  int y2;
-  std::vector<double>::iterator low1;
-  std::vector<double>::iterator low2;
+};
 
-  /* Binary search for indices */
-  low1 = std::lower_bound (lut.loadIndices.begin(), lut.loadIndices.end(), index1 );
-  low2 = std::lower_bound (lut.transitionIndices.begin(), lut.transitionIndices.end(), index2 );
-  x1 = low1 - lut.loadIndices.begin();
-  y1 = low2 - lut.transitionIndices.begin();
+template <bool ATOMIC, class TIMING>
+static inline void merge_record( TIMING& pin, const TimingRecord& t ) {
 
-  /* Special cases for index1 */
-  if ( low1 == lut.loadIndices.end() ) {
-    x1 = x1 - 2;
-    x2 = x1 + 1;
-  }
-  else if ( lut.loadIndices[x1] == index1 ) {
-    x2 = x1;
-  }
-  else if ( low1 == lut.loadIndices.begin() ) {
-    x2 = x1 + 1;
+  if constexpr ( ATOMIC ) {
+    atomic_merge_early( pin.tr_r_early, t.tr_r_early );
+    atomic_merge_early( pin.tr_f_early, t.tr_f_early );
+    atomic_merge_late( pin.tr_r_late, t.tr_r_late );
+    atomic_merge_late( pin.tr_f_late, t.tr_f_late );
+
+    atomic_merge_early( pin.at_r_early, t.at_r_early );
+    atomic_merge_early( pin.at_f_early, t.at_f_early );
+    atomic_merge_late( pin.at_r_late, t.at_r_late );
+    atomic_merge_late( pin.at_f_late, t.at_f_late );
   }
   else {
-    x2 = x1;
-    x1--;
+    merge_early( pin.tr_r_early, t.tr_r_early );
+    merge_early( pin.tr_f_early, t.tr_f_early );
+    merge_late( pin.tr_r_late, t.tr_r_late );
+    merge_late( pin.tr_f_late, t.tr_f_late );
+
+    merge_early( pin.at_r_early, t.at_r_early );
+    merge_early( pin.at_f_early, t.at_f_early );
+    merge_late( pin.at_r_late, t.at_r_late );
+    merge_late( pin.at_f_late, t.at_f_late );
   }
 
-  /* Special cases for index2 */
-  if ( low2 == lut.transitionIndices.end() ) {
-    y1 = y1 - 2;
-    y2 = y1 + 1;
-  }
-  else if ( lut.transitionIndices[y1] == index2 ) {
-    y2 = y1;
+}
+
+/* Evaluate an in-cell timing arc from prev (cell input) to its output. *
+ * The arc delays are stored to the edge. There is one instance per     *
+ * timing sense, so picking the input edges folds away at compile time. */
+template <TimingSense SENSE, class TIMING, class DELAYS>
+static TimingRecord evaluate_arc( const TIMING& prev, DELAYS& arc, const ArcLUT& lut,
+                                  const LibParserTimingInfo& info, double fan_out ) {
+
+  TimingRecord t;
+  double slew[2 * LUT_COUNT];
+  double out[2 * LUT_COUNT];
+
+  /* Input transition of every table, early then late. The transition *
+   * and delay tables of an output edge see the same input edge.      */
+  if constexpr ( SENSE == POSITIVE_UNATE ) {
+    slew[0] = slew[2] = prev.tr_r_early;
+    slew[1] = slew[3] = prev.tr_f_early;
+    slew[4] = slew[6] = prev.tr_r_late;
+    slew[5] = slew[7] = prev.tr_f_late;
   }
-  else if ( low2 == lut.transitionIndices.begin() ) {
-    y2 = y1 + 1;
+  else if constexpr ( SENSE == NEGATIVE_UNATE ) {
+    slew[0] = slew[2] = prev.tr_f_early;
+    slew[1] = slew[3] = prev.tr_r_early;
+    slew[4] = slew[6] = prev.tr_f_late;
+    slew[5] = slew[7] = prev.tr_r_late;
   }
   else {
-    y2 = y1;
-    y1--;
+    /* Non unate: both output edges follow either input edge */
+    slew[0] = slew[1] = slew[2] = slew[3] = std::min( prev.tr_f_early, prev.tr_r_early );
+    slew[4] = slew[5] = slew[6] = slew[7] = std::max( prev.tr_f_late, prev.tr_r_late );
   }
 
-  if ( x1 == x2 && y1 == y2 ) {
+  interpolate_lut( lut, info, fan_out, slew, out );
 
-    result = lut.tableVals[y1][x1];
+  t.tr_r_early = out[LUT_RISE_TRANSITION];
+  t.tr_f_early = out[LUT_FALL_TRANSITION];
+  t.tr_r_late = out[LUT_COUNT + LUT_RISE_TRANSITION];
+  t.tr_f_late = out[LUT_COUNT + LUT_FALL_TRANSITION];
 
+  arc.dr_EARLY = out[LUT_RISE_DELAY];
+  arc.df_EARLY = out[LUT_FALL_DELAY];
+  arc.dr_LATE = out[LUT_COUNT + LUT_RISE_DELAY];
+  arc.df_LATE = out[LUT_COUNT + LUT_FALL_DELAY];
+
+  if constexpr ( SENSE == POSITIVE_UNATE ) {
+    t.at_r_early = prev.at_r_early + arc.dr_EARLY;
+    t.at_f_early = prev.at_f_early + arc.df_EARLY;
+    t.at_r_late = prev.at_r_late + arc.dr_LATE;
+    t.at_f_late = prev.at_f_late + arc.df_LATE;
+  }
+  else if constexpr ( SENSE == NEGATIVE_UNATE ) {
+    t.at_r_early = prev.at_f_early + arc.dr_EARLY;
+    t.at_f_early = prev.at_r_early + arc.df_EARLY;
+    t.at_r_late = prev.at_f_late + arc.dr_LATE;
+    t.at_f_late = prev.at_r_late + arc.df_LATE;
+  }
+  else {
+    double at_EARLY = std::min( prev.at_f_early, prev.at_r_early );
+    double at_LATE = std::max( prev.at_f_late, prev.at_r_late );
+    t.at_r_early = at_EARLY + arc.dr_EARLY;
+    t.at_f_early = at_EARLY + arc.df_EARLY;
+    t.at_r_late = at_LATE + arc.dr_LATE;
+    t.at_f_late = at_LATE + arc.df_LATE;
   }
-  else if ( x1 == x2 && y1 != y2 ) {
 
-    result = (lut.tableVals[y2][x1] - lut.tableVals[y1][x1]);
-    result = result/( lut.transitionIndices[y2] - lut.transitionIndices[y1] );
-    result = lut.tableVals[y1][x1] + ( index2 - lut.transitionIndices[y1] )*result;
+  return t;
+
+}
 
-  } 
-  else if ( x1 != x2 && y1 == y2 ) {
+/* What a timing edge from a timed pin gives its sink. Wires pass the *
+ * slew through and add the net delay to the arrival; arcs are        *
+ * evaluated at the load of the sink.                                 */
+template <class CORNER>
+static TimingRecord fanin_record( const CORNER& corner, EdgeId e ) {
 
-    result = (lut.tableVals[y1][x2] - lut.tableVals[y1][x1]);
-    result = result/( lut.loadIndices[x2] - lut.loadIndices[x1] );
-    result = lut.tableVals[y1][x1] + ( index1 - lut.loadIndices[x1] )*result;
+  const NetsInfo& edge = EdgeTable[e];
+  const auto& prev = corner.timing( edge.fromPin );
+  auto& delays = corner.delays( e );
 
-  } 
-  else if ( x1 != x2 && y1 != y2 ) {
+  if ( edge.net != INVALID_ID ) {
 
-    double z_first, z_sec;
+    TimingRecord t;
 
-    z_first = (lut.tableVals[y1][x2] - lut.tableVals[y1][x1]);
-    z_first = z_first/( lut.loadIndices[x2] - lut.loadIndices[x1] );
-    z_first = lut.tableVals[y1][x1] + ( index1 - lut.loadIndices[x1] )*z_first;
+    t.tr_r_early = prev.tr_r_early;
+    t.tr_f_early = prev.tr_f_early;
+    t.tr_r_late = prev.tr_r_late;
+    t.tr_f_late = prev.tr_f_late;
 
-    z_sec = (lut.tableVals[y2][x2] - lut.tableVals[y2][x1]);
-    z_sec = z_sec/( lut.loadIndices[x2] - lut.loadIndices[x1] );
-    z_sec = lut.tableVals[y2][x1] + ( index1 - lut.loadIndices[x1] )*z_sec;
+    t.at_r_early = prev.at_r_early + delays.delay;
+    t.at_f_early = prev.at_f_early + delays.delay;
+    t.at_r_late = prev.at_r_late + delays.delay;
+    t.at_f_late = prev.at_f_late + delays.delay;
 
-    result = (z_sec - z_first);
-    result = result/( lut.transitionIndices[y2] - lut.transitionIndices[y1] );
-    result = z_first + ( index2 - lut.transitionIndices[y1] )*result;
+    return t;
+  }
 
-  } 
+  NetId net = PinTable[edge.toPin].net;
+  double fan_out = ( net == INVALID_ID ) ? 0 : corner.load( net );
+  const LibParserTimingInfo& info = corner.arc( edge.arc );
+  const ArcLUT& lut = corner.lut( edge.arc );
 
-  return result;
+  switch ( info.sense ) {
+    case POSITIVE_UNATE: return evaluate_arc<POSITIVE_UNATE>( prev, delays, lut, info, fan_out );
+    case NEGATIVE_UNATE: return evaluate_arc<NEGATIVE_UNATE>( prev, delays, lut, info, fan_out );
+    default: return evaluate_arc<NON_UNATE>( prev, delays, lut, info, fan_out );
+  }
 
 }
 
-/* BFS algorithm implementation for forward traversal */
-int find_nets_delay() {
+/* Pin without fanin. Primary inputs take their assertions, *
+ * anything else (a floating input) stays untimed. The       *
+ * assertions are the same at every corner.                  */
+template <class CORNER>
+static void seed_source( const CORNER& corner, PinId p ) {
 
-  string cellType ;
-  string pinName;
-  string instance_name ;
-  string NetsKey;
+  auto& pin = corner.timing( p );
 
-#ifdef DEBUG
+  reset_timing( pin );
 
-  for ( auto it = Nets.begin(); it != Nets.end(); ++it ) {
-    cout << "Key: " << it->first << endl << "From instance name: " << (it->second).fromPin.instance_name << " From pinName: " << (it->second).fromPin.pinName << endl;
-    cout << "To instance name: " << (it->second).toPin.instance_name << " to pinName: " << (it->second).toPin.pinName << endl <<endl;
-  }
+  if ( PinTable[p].cell != INVALID_ID )
+    return;
 
-#endif
+  auto it = PIs.find( PinNames.name(p) );
+  if ( it == PIs.end() )
+    return;
 
-  /* For forward traversal level 0 is PIs' connections */
-  vector<NetPin> fwdLevel0;
-  vector<string> Visited;
-  unsigned int level = 0;
+  const pi_values& values = it->second;
 
-  // ypologismos Net delay me spef
-  for ( auto it = PIs.begin(); it != PIs.end(); it++ ) {
-    fwdLevel0.insert( fwdLevel0.end(), (it->second).linksTo.begin(), (it->second).linksTo.end() );
+  pin.at_r_early = values.early_rise_at;
+  pin.at_f_early = values.early_fall_at;
+  pin.at_r_late = values.late_rise_at;
+  pin.at_f_late = values.late_fall_at;
+  pin.tr_r_early = values.tr_r_early;
+  pin.tr_f_early = values.tr_f_early;
+  pin.tr_r_late = values.tr_r_late;
+  pin.tr_f_late = values.tr_f_late;
 
-    /* Calculate delay for all inputs */
-    for ( auto k = (it->second).linksTo.begin(); k != (it->second).linksTo.end(); k++ ) {
+}
 
-      NetsKey = it->first + k->instance_name + k->pinName;
-      /* Calculate and store delay to Nets hash table */
-      Nets[NetsKey].delay = calculate_net_delay( it->first, k->instance_name);
+/* Time a pin at one corner from all of its fanin edges. The fanin *
+ * pins must be done. Arc delays are stored to the fanin edges, net *
+ * delays are already on them. A fanin is timed at every corner or  *
+ * at none, so the primary corner tells.                            */
+template <class CORNER>
+static void time_pin( const CORNER& corner, PinId p ) {
 
-    }
-   
+  if ( FaninBegin[p] == FaninBegin[p + 1] ) {
+    seed_source( corner, p );
+    return;
   }
 
-  bool isFinalLevel = false;
-  vector<NetPin> currLevel = fwdLevel0;
-  vector<NetPin> nextLevel;
-  nextLevel.clear();
+  auto& pin = corner.timing( p );
+  reset_timing( pin );
 
-  /* Begin traversing graph */
-  while ( !isFinalLevel ) {
-    
-    isFinalLevel = true;
+  /* In-cell connections without a library arc (d -> q of a flip flop) *
+   * do not time the output                                            */
+  for ( EdgeId i = FaninBegin[p]; i < FaninBegin[p + 1]; i++ ) {
 
-    /* Start iterating current level */
-    for (std::vector<NetPin>::const_iterator i = currLevel.begin(); i != currLevel.end(); ++i) {
+    const NetsInfo& edge = EdgeTable[FaninEdges[i]];
 
-      string key =  i->instance_name + i->pinName;
+    if ( is_timing_edge( edge ) && is_timed( PinTable[edge.fromPin] ) )
+      merge_record<false>( pin, fanin_record( corner, FaninEdges[i] ) );
+  }
 
-      /* Build next level. Check if pin is in visited list. TODO: make list bitmap */
-      if ( std::find(Visited.begin(), Visited.end(), key) == Visited.end() ) {
-        isFinalLevel = false;
+}
 
-        // Insert pin to visited list
-        Visited.insert(Visited.end(), key );
+/* Time a pin at every corner. Used by update_timing, the lazy *
+ * queries and the single threaded full pass.                  */
+static void propagate_pin( PinId p ) {
 
-        /* If pin is input, that means that it is connected in-cell. *
-         * So we need to call interpolation/extrapolation functions, *
-         * else calculate delay with wire capacitances               */
-        if ( Pins[key].isInput ) {
+  time_pin( PrimaryCorner(), p );
 
-          double fan_out;
-          string nxtKey;
-          string netkey;
+  for ( unsigned int k = 0; k < Corners.size(); k++ )
+    time_pin( ExtraCorner( k ), p );
 
-          /* For is not needed because we only have one in-cell *
-           * connection but makes our life easier cause we      * 
-           * don't have to check if list is empty manually      */
-          for ( auto j = Pins[key].linksTo.begin(); j != Pins[key].linksTo.end(); j++ ) {
-            
-            /* Make key for Nets hash table. */
-            nxtKey = j->instance_name + j->pinName;
-            netkey = key + j->instance_name + j->pinName;
+}
 
-            fan_out = calculate_fanout( nxtKey, Pins[nxtKey].connNetName );
+template <class CORNER>
+static void push_corner( const CORNER& corner, PinId p ) {
 
-          }
-          /* TODO: fix FFs*/
-          if ( nxtKey.empty() )
-              goto fuckFF;
+  for ( EdgeId e = FanoutBegin[p]; e < FanoutBegin[p + 1]; e++ )
+    if ( is_timing_edge( EdgeTable[e] ) )
+      merge_record<true>( corner.timing( EdgeTable[e].toPin ), fanin_record( corner, e ) );
 
-          if ( Pins[key].linkedBy.empty() ) {
-            printf("Error. Linked by empty!\n");
-            exit(0);
-          }
-          string prevKey =  Pins[key].linkedBy[0].instance_name + Pins[key].linkedBy[0].pinName;
-          string cellName = i->cellType;
-
-          /* Find min - max */
-          Pins[key].tr_r_early = std::min( Pins[key].tr_r_early, Pins[prevKey].tr_r_early );
-          Pins[key].tr_f_early = std::min( Pins[key].tr_f_early, Pins[prevKey].tr_f_early );
-          Pins[key].tr_r_late = std::max( Pins[key].tr_r_early, Pins[prevKey].tr_r_early );
-          Pins[key].tr_f_late = std::max( Pins[key].tr_f_early, Pins[prevKey].tr_f_early );
-    
-          auto timingArc = std::find_if ( Cells[cellName].timingArcs.begin(), Cells[cellName].timingArcs.end(), findTimingArchPin( i->pinName ));
-          double tr_r_LATE, tr_f_LATE;
-          double tr_r_EARLY, tr_f_EARLY;
+}
 
-          /* Positive unate */
-          if ( timingArc->timingSense == "positive_unate" ) { 
+/* Push a pin that is done to the pins of its fanout edges, at every  *
+ * corner. Those are on later levels, and the pins of one level push  *
+ * in parallel, so the fanout pins are merged into atomically. Only   *
+ * the fanout edges of the pin are written otherwise. Used by the     *
+ * parallel forward pass.                                             */
+static void push_pin( PinId p ) {
+
+  if ( FaninBegin[p] == FaninBegin[p + 1] ) {
+    seed_source( PrimaryCorner(), p );
+    for ( unsigned int k = 0; k < Corners.size(); k++ )
+      seed_source( ExtraCorner( k ), p );
+  }
 
-            /* Call interpolation */
-            tr_r_EARLY = BilinearInterpol( fan_out, Pins[key].tr_r_early, timingArc->riseTransition );
-            tr_f_EARLY = BilinearInterpol( fan_out, Pins[key].tr_f_early, timingArc->fallTransition );
-            tr_r_LATE = BilinearInterpol( fan_out, Pins[key].tr_r_late, timingArc->riseTransition );
-            tr_f_LATE = BilinearInterpol( fan_out, Pins[key].tr_f_late, timingArc->fallTransition );
+  if ( !is_timed( PinTable[p] ) )
+    return;
 
-            /* Call interpolation for nets */
-            Nets[netkey].dr_EARLY = BilinearInterpol( fan_out, Pins[key].tr_r_early, timingArc->riseDelay );
-            Nets[netkey].df_EARLY = BilinearInterpol( fan_out, Pins[key].tr_f_early, timingArc->fallDelay );
-            Nets[netkey].dr_LATE = BilinearInterpol( fan_out, Pins[key].tr_r_late, timingArc->riseDelay );
-            Nets[netkey].df_LATE = BilinearInterpol( fan_out, Pins[key].tr_f_late, timingArc->fallDelay );
+  push_corner( PrimaryCorner(), p );
 
-          }
-          else if ( timingArc->timingSense == "negative_unate" ) { 
+  for ( unsigned int k = 0; k < Corners.size(); k++ )
+    push_corner( ExtraCorner( k ), p );
 
-            /* Call interpolation */
-            tr_r_EARLY = BilinearInterpol( fan_out, Pins[key].tr_f_early, timingArc->riseTransition );
-            tr_f_EARLY = BilinearInterpol( fan_out, Pins[key].tr_r_early, timingArc->fallTransition );
-            tr_r_LATE = BilinearInterpol( fan_out, Pins[key].tr_f_late, timingArc->riseTransition );
-            tr_f_LATE = BilinearInterpol( fan_out, Pins[key].tr_r_late, timingArc->fallTransition );
+}
 
-            /* Call interpolation for nets */
-            Nets[netkey].dr_EARLY = BilinearInterpol( fan_out, Pins[key].tr_f_early, timingArc->riseDelay );
-            Nets[netkey].df_EARLY = BilinearInterpol( fan_out, Pins[key].tr_r_early, timingArc->fallDelay );
-            Nets[netkey].dr_LATE = BilinearInterpol( fan_out, Pins[key].tr_f_late, timingArc->riseDelay );
-            Nets[netkey].df_LATE = BilinearInterpol( fan_out, Pins[key].tr_r_late, timingArc->fallDelay );
+/* Pins waiting for update_timing, by level */
+static vector< vector<PinId> > FwdDirty;
+static vector< vector<PinId> > BwdDirty;
+static vector<NetId> DirtyNets;
+double TimingEpsilon = 0;
+
+/* Netlist edits since the last update_timing. They only change the  *
+ * pin and net tables; the edges of the nets they rewired, the CSR,  *
+ * the levels and the ids are redone once, by rebuild_graph.         */
+static bool TopologyDirty = false;
+static vector<NetId> RewiredNets;
+static vector<PinId> RemovedPins;
+
+/* Lazy timing. Set by begin_lazy_timing, cleared by find_nets_delay. *
+ * A required time is up to date while its ratStamp is RequiredStamp, *
+ * so any edit drops all of them at once by moving the stamp on.      */
+static bool LazyTiming = false;
+static unsigned int RequiredStamp = 1;
+
+/* Pins a cone walk has seen while their stamp is ConeStamp */
+static vector<unsigned int> ConeVisit;
+static unsigned int ConeStamp = 0;
+
+/* Unfinished timing fanins (forward) or fanouts (backward) of every *
+ * pin, for the task graph passes. A pin is ready when its count     *
+ * drops to 0.                                                       */
+static vector< std::atomic<unsigned int> > Pending;
+
+static void count_pending( bool forward ) {
+
+  if ( Pending.size() != PinTable.size() )
+    Pending = vector< std::atomic<unsigned int> >( PinTable.size() );
+
+  for ( PinId p = 0; p < PinTable.size(); p++ )
+    Pending[p].store( 0, std::memory_order_relaxed );
+
+  /* Pins on loops never finish, so they hold up nothing backward */
+  for ( EdgeId e = 0; e < EdgeTable.size(); e++ ) {
+    const NetsInfo& edge = EdgeTable[e];
+    if ( !is_timing_edge( edge ) )
+      continue;
+    if ( forward )
+      Pending[edge.toPin].fetch_add( 1, std::memory_order_relaxed );
+    else if ( PinLevel[edge.toPin] != INVALID_ID )
+      Pending[edge.fromPin].fetch_add( 1, std::memory_order_relaxed );
+  }
 
-          }
-          else if ( timingArc->timingSense == "non_unate" ) {
+}
 
-            /* Call interpolation */
-            double tr_EARLY = std::min( Pins[key].tr_f_early, Pins[key].tr_r_early );
-            double tr_LATE = std::max( Pins[key].tr_f_late, Pins[key].tr_r_late );
+/* Forward traversal. Every pin is a task that runs once all of its   *
+ * fanins have pushed into it, then pushes to its fanout and releases *
+ * the fanout pins it was the last fanin of. There are no barriers    *
+ * between levels, so a deep narrow cone keeps going while the rest   *
+ * of the threads work elsewhere. The merges are min and max, so the  *
+ * result does not depend on the order they land in or on the number  *
+ * of threads.                                                        */
+int find_nets_delay() {
 
-            tr_r_EARLY = BilinearInterpol( fan_out, tr_EARLY, timingArc->riseTransition );
-            tr_f_EARLY = BilinearInterpol( fan_out, tr_EARLY, timingArc->fallTransition );
-            tr_r_LATE = BilinearInterpol( fan_out, tr_LATE, timingArc->riseTransition );
-            tr_f_LATE = BilinearInterpol( fan_out, tr_LATE, timingArc->fallTransition );
+#ifdef DEBUG
 
-            /* Call interpolation for nets */
-            Nets[netkey].dr_EARLY = BilinearInterpol( fan_out, tr_EARLY, timingArc->riseDelay );
-            Nets[netkey].df_EARLY = BilinearInterpol( fan_out, tr_EARLY, timingArc->fallDelay );
-            Nets[netkey].dr_LATE = BilinearInterpol( fan_out, tr_LATE, timingArc->riseDelay );
-            Nets[netkey].df_LATE = BilinearInterpol( fan_out, tr_LATE, timingArc->fallDelay );
+  for ( EdgeId e = 0; e < EdgeTable.size(); ++e ) {
+    cout << "Edge: " << e << endl << "From: " << PinNames.name(EdgeTable[e].fromPin) << endl;
+    cout << "To: " << PinNames.name(EdgeTable[e].toPin) << endl <<endl;
+  }
 
-          }
+#endif
 
-          if ( tr_f_LATE > Pins[nxtKey].tr_f_late ) 
-      			Pins[nxtKey].tr_f_late = tr_f_LATE;
+  levelize();
+  LazyTiming = false;
 
-			    if ( tr_r_LATE > Pins[nxtKey].tr_r_late ) 
-      			Pins[nxtKey].tr_r_late = tr_r_LATE;
+  /* Pins on a loop are never visited, they stay untimed */
+  for ( PinId p = 0; p < PinTable.size(); p++ ) {
+    reset_timing( PinTable[p] );
+    PinTable[p].fwdDirty = PinTable[p].bwdDirty = false;
+  }
 
-			    if ( tr_f_EARLY < Pins[nxtKey].tr_f_early ) 
-      			Pins[nxtKey].tr_f_early =  tr_f_EARLY;
+  for ( auto it = CornerPins.begin(); it != CornerPins.end(); it++ )
+    reset_timing( *it );
 
-			    if ( tr_r_EARLY < Pins[nxtKey].tr_r_early ) 
-      			Pins[nxtKey].tr_r_early =  tr_r_EARLY;
+  FwdDirty.assign( LevelBegin.size() - 1, vector<PinId>() );
+  BwdDirty.assign( LevelBegin.size() - 1, vector<PinId>() );
 
-        }
-        else {
+  ThreadPool& pool = thread_pool();
 
-          /* Iterate through all connections and calculate total delay. */
-          for ( auto k = Pins[key].linksTo.begin(); k != Pins[key].linksTo.end(); k++ ) {
+  /* One thread needs neither the atomics nor the level barriers. It *
+   * pulls, which keeps the pin it writes in cache.                  */
+  if ( pool.size() == 1 ) {
+    for ( PinId i = 0; i < LevelPins.size(); i++ )
+      propagate_pin( LevelPins[i] );
+  }
+  else if ( !LevelPins.empty() ) {
 
-            if ( k->instance_name.empty() ) // primary output
-              NetsKey = Pins[key].connNetName ;
-            else
-              NetsKey = Pins[key].connNetName + k->instance_name + k->pinName;
+    count_pending( true );
 
-            /* Calculate and store delay to Nets hash table */
-            Nets[NetsKey].delay = calculate_net_delay( Pins[key].connNetName , k->instance_name);
+    vector<uint32_t> roots( LevelPins.begin(), LevelPins.begin() + LevelBegin[1] );
 
-          }
+    pool.run_graph( roots, LevelPins.size(), [] ( uint32_t p, vector<uint32_t>& ready ) {
 
-        }
-fuckFF:
-        nextLevel.insert( nextLevel.end(), Pins[key].linksTo.begin(), Pins[key].linksTo.end() );
-      }
-    }
+      push_pin( p );
 
-    /* Clear nextLevel for next iteration */
-    currLevel = nextLevel;
-    nextLevel.clear();
-    level++;
+      for ( EdgeId e = FanoutBegin[p]; e < FanoutBegin[p + 1]; e++ )
+        if ( is_timing_edge( EdgeTable[e] ) &&
+             Pending[EdgeTable[e].toPin].fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+          ready.push_back( EdgeTable[e].toPin );
+    } );
+
+    /* Pins on loops are not on a level. Some of their fanins may have *
+     * pushed into them, but they stay untimed.                        */
+    if ( LevelPins.size() != PinTable.size() )
+      for ( PinId p = 0; p < PinTable.size(); p++ )
+        if ( PinLevel[p] == INVALID_ID ) {
+          reset_timing( PinTable[p] );
+          for ( unsigned int k = 0; k < Corners.size(); k++ )
+            reset_timing( ExtraCorner( k ).timing( p ) );
+        }
   }
 
+  /* Clock tree and pessimism credits for CPPR */
+  build_clock_tree();
+
 #ifdef DEBUG
-  for ( auto i = Nets.begin(); i != Nets.end(); i++ ) {
-      cout << "Net: " << i->first << endl;
-      cout << "\t dr_EARLY: " << (i->second).dr_EARLY << endl;
-      cout << "\t dr_LATE: " << (i->second).dr_LATE << endl;
-      cout << "\t df_EARLY: " << (i->second).df_EARLY << endl;
-      cout << "\t df_LATE: " << (i->second).df_LATE << endl;
+  for ( EdgeId e = 0; e < EdgeTable.size(); ++e ) {
+      cout << "Edge: " << PinNames.name(EdgeTable[e].fromPin) << " -> " << PinNames.name(EdgeTable[e].toPin) << endl;
+      cout << "\t delay: " << EdgeTable[e].delay << endl;
+      cout << "\t dr_EARLY: " << EdgeTable[e].dr_EARLY << endl;
+      cout << "\t dr_LATE: " << EdgeTable[e].dr_LATE << endl;
+      cout << "\t df_EARLY: " << EdgeTable[e].df_EARLY << endl;
+      cout << "\t df_LATE: " << EdgeTable[e].df_LATE << endl;
   }
 
-  for ( auto i = SpefNets.begin(); i != SpefNets.end(); i++ ) 
-    cout << " sssssD: " << i->first << " delay: " << (i->second).netLumpedCap << endl;
+  for ( NetId n = 0; n < NetTable.size(); n++ ) 
+    if ( NetTable[n].spef != nullptr )
+      cout << " sssssD: " << NetNames.name(n) << " delay: " << NetTable[n].spef->netLumpedCap << endl;
 #endif
 
   return 1;
 
 }
 
+/* Required times before any endpoint reached the pin: *
+ * unconstrained, late at +max and early at -max       */
+template <class TIMING>
+static void reset_required( TIMING& pin ) {
+
+  pin.rat_r_early = pin.rat_f_early = -std::numeric_limits<double>::max();
+  pin.rat_r_late = pin.rat_f_late = std::numeric_limits<double>::max();
+
+}
+
+template <class TIMING>
+static inline bool is_constrained( const TIMING& pin ) {
+  return pin.rat_r_late != std::numeric_limits<double>::max();
+}
+
+/* Worst of rise and fall. Late slack is rat - at, early slack is at - rat */
+template <class TIMING>
+static void compute_slack( TIMING& pin ) {
+
+  if ( !is_timed( pin ) || !is_constrained( pin ) ) {
+    pin.slack_early = pin.slack_late = std::numeric_limits<double>::max();
+    return;
+  }
+
+  pin.slack_late = std::min( pin.rat_r_late - pin.at_r_late, pin.rat_f_late - pin.at_f_late );
+  pin.slack_early = std::min( pin.at_r_early - pin.rat_r_early, pin.at_f_early - pin.rat_f_early );
+
+}
+
+/* Pin without timing fanout. Primary outputs take their assertions and *
+ * the data pins of flip flops are checked against the clock, one       *
+ * period after the clock edge less the setup time for the late times,  *
+ * and at the clock edge plus the hold time for the early ones. Setup   *
+ * uses the late data slew and early clock slew, hold the opposite.     *
+ * Without a library check the time counts as zero. Anything else stays *
+ * unconstrained.                                                       */
+template <class CORNER>
+static void seed_endpoint( const CORNER& corner, PinId p ) {
+
+  const VerParserPinInfo& info = PinTable[p];
+  auto& pin = corner.timing( p );
+
+  reset_required( pin );
+
+  if ( info.cell == INVALID_ID ) {
+
+    auto it = POs.find( PinNames.name(p) );
+    if ( it == POs.end() || !it->second.isConstrained )
+      return;
+
+    const po_values& values = it->second;
+
+    pin.rat_r_early = values.early_rise_rat;
+    pin.rat_f_early = values.early_fall_rat;
+    pin.rat_r_late = values.late_rise_rat;
+    pin.rat_f_late = values.late_fall_rat;
+    return;
+  }
+
+  if ( ClockPeriod <= 0 || !info.isInput || !CellTable[info.cell]->isSequential )
+    return;
+
+  PinId clock = InstanceClock[p];
+  if ( clock == INVALID_ID || clock == p || !is_timed( PinTable[clock] ) )
+    return;
+
+  const auto& ck = corner.timing( clock );
+  double setupR = 0, setupF = 0, holdR = 0, holdF = 0;
+
+  if ( SetupArc[p] != INVALID_ID && is_timed( pin ) ) {
+    const LibParserTimingInfo& arc = corner.arc( SetupArc[p] );
+    setupR = ConstraintInterpol( pin.tr_r_late, ck.tr_r_early, arc.riseConstraint );
+    setupF = ConstraintInterpol( pin.tr_f_late, ck.tr_r_early, arc.fallConstraint );
+  }
+
+  if ( HoldArc[p] != INVALID_ID && is_timed( pin ) ) {
+    const LibParserTimingInfo& arc = corner.arc( HoldArc[p] );
+    holdR = ConstraintInterpol( pin.tr_r_early, ck.tr_r_late, arc.riseConstraint );
+    holdF = ConstraintInterpol( pin.tr_f_early, ck.tr_r_late, arc.fallConstraint );
+  }
+
+  pin.rat_r_early = ck.at_r_late + holdR;
+  pin.rat_f_early = ck.at_r_late + holdF;
+  pin.rat_r_late = ck.at_r_early + ClockPeriod - setupR;
+  pin.rat_f_late = ck.at_r_early + ClockPeriod - setupF;
+
+}
+
+/* Required times of a pin at one corner from all of its fanout edges. *
+ * The fanout pins must be done.                                     */
+template <class CORNER>
+static void required_pin( const CORNER& corner, PinId p ) {
+
+  auto& pin = corner.timing( p );
+  CornerTiming req;
+  bool hasFanout = false;
+
+  reset_required( req );
+
+  for ( EdgeId e = FanoutBegin[p]; e < FanoutBegin[p + 1]; e++ ) {
+
+    const NetsInfo& info = EdgeTable[e];
+    const auto& edge = corner.delays( e );
+    const auto& next = corner.timing( info.toPin );
+
+    if ( !is_timing_edge( info ) )
+      continue;
+
+    hasFanout = true;
+
+    if ( !is_constrained( next ) )
+      continue;
+
+    /* Late required times keep the minimum, early ones the maximum */
+    if ( info.net != INVALID_ID ) {
+
+      merge_late( req.rat_r_early, next.rat_r_early - edge.delay );
+      merge_late( req.rat_f_early, next.rat_f_early - edge.delay );
+      merge_early( req.rat_r_late, next.rat_r_late - edge.delay );
+      merge_early( req.rat_f_late, next.rat_f_late - edge.delay );
+
+    }
+    else if ( corner.arc( info.arc ).sense == POSITIVE_UNATE ) {
+
+      merge_late( req.rat_r_early, next.rat_r_early - edge.dr_EARLY );
+      merge_late( req.rat_f_early, next.rat_f_early - edge.df_EARLY );
+      merge_early( req.rat_r_late, next.rat_r_late - edge.dr_LATE );
+      merge_early( req.rat_f_late, next.rat_f_late - edge.df_LATE );
+
+    }
+    else if ( corner.arc( info.arc ).sense == NEGATIVE_UNATE ) {
+
+      /* A rising input makes the output fall */
+      merge_late( req.rat_r_early, next.rat_f_early - edge.df_EARLY );
+      merge_late( req.rat_f_early, next.rat_r_early - edge.dr_EARLY );
+      merge_early( req.rat_r_late, next.rat_f_late - edge.df_LATE );
+      merge_early( req.rat_f_late, next.rat_r_late - edge.dr_LATE );
+
+    }
+    else {
+
+      /* Non unate: either input edge must meet both output edges */
+      double early = std::max( next.rat_r_early - edge.dr_EARLY, next.rat_f_early - edge.df_EARLY );
+      double late = std::min( next.rat_r_late - edge.dr_LATE, next.rat_f_late - edge.df_LATE );
+
+      merge_late( req.rat_r_early, early );
+      merge_late( req.rat_f_early, early );
+      merge_early( req.rat_r_late, late );
+      merge_early( req.rat_f_late, late );
+
+    }
+  }
+
+  if ( hasFanout ) {
+    pin.rat_r_early = req.rat_r_early;
+    pin.rat_f_early = req.rat_f_early;
+    pin.rat_r_late = req.rat_r_late;
+    pin.rat_f_late = req.rat_f_late;
+  }
+  else
+    seed_endpoint( corner, p );
+
+  compute_slack( pin );
+
+}
+
+/* Required times of a pin at every corner */
+static void propagate_pin_bwd( PinId p ) {
+
+  required_pin( PrimaryCorner(), p );
+
+  for ( unsigned int k = 0; k < Corners.size(); k++ )
+    required_pin( ExtraCorner( k ), p );
+
+}
+
+/* Backward traversal for required arrival times and slack. A pin *
+ * runs once all of its fanouts are done and only writes itself.  */
 int bfs_on_graph_bwd() {
 
+  for ( PinId p = 0; p < PinTable.size(); p++ )
+    reset_required( PinTable[p] );
+
+  for ( auto it = CornerPins.begin(); it != CornerPins.end(); it++ )
+    reset_required( *it );
+
+  ThreadPool& pool = thread_pool();
+
+  if ( pool.size() == 1 ) {
+    for ( PinId i = LevelPins.size(); i > 0; i-- )
+      propagate_pin_bwd( LevelPins[i - 1] );
+  }
+  else {
+
+    /* Same task graph as the forward pass, the other way around */
+    count_pending( false );
+
+    vector<uint32_t> roots;
+    for ( PinId i = 0; i < LevelPins.size(); i++ )
+      if ( Pending[LevelPins[i]].load( std::memory_order_relaxed ) == 0 )
+        roots.push_back( LevelPins[i] );
+
+    pool.run_graph( roots, LevelPins.size(), [] ( uint32_t p, vector<uint32_t>& ready ) {
+
+      propagate_pin_bwd( p );
+
+      for ( EdgeId i = FaninBegin[p]; i < FaninBegin[p + 1]; i++ ) {
+        const NetsInfo& edge = EdgeTable[FaninEdges[i]];
+        if ( is_timing_edge( edge ) && Pending[edge.fromPin].fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+          ready.push_back( edge.fromPin );
+      }
+    } );
+  }
+
+  return 1;
+
+}
+
+/* Parasitics of the dirty nets may have changed */
+static void update_dirty_nets() {
+
+  for ( auto it = DirtyNets.begin(); it != DirtyNets.end(); it++ ) {
+    SpefNet* spef = NetTable[*it].spef;
+    if ( spef != nullptr && !spef->isReduced )
+      index_spef_net( *spef );
+    update_net( *it );
+    NetTable[*it].dirty = false;
+  }
+
+  DirtyNets.clear();
+
+}
+
+static inline bool is_done( const VerParserPinInfo& pin, bool forward ) {
+  return forward ? pin.atValid : pin.ratStamp == RequiredStamp;
+}
+
+/* The pins of the fanin (forward) or fanout cone of roots that are not *
+ * up to date, each one after all the pins it depends on. The walk      *
+ * stops at pins that are, and at pins on loops, which stay untimed.    */
+static void collect_cone( const vector<PinId>& roots, bool forward, vector<PinId>& order ) {
+
+  if ( ConeVisit.size() != PinTable.size() )
+    ConeVisit.assign( PinTable.size(), 0 );
+
+  if ( ++ConeStamp == 0 ) {
+    std::fill( ConeVisit.begin(), ConeVisit.end(), 0 );
+    ConeStamp = 1;
+  }
+
+  vector< std::pair<PinId, EdgeId> > stack;   // pin, next edge
+
+  for ( auto it = roots.begin(); it != roots.end(); it++ ) {
+
+    if ( PinLevel[*it] == INVALID_ID || is_done( PinTable[*it], forward ) || ConeVisit[*it] == ConeStamp )
+      continue;
+
+    ConeVisit[*it] = ConeStamp;
+    stack.push_back( std::make_pair( *it, forward ? FaninBegin[*it] : FanoutBegin[*it] ) );
+
+    /* Depth first, a pin goes out after all of its fanins (fanouts) */
+    while ( !stack.empty() ) {
+
+      PinId p = stack.back().first;
+      EdgeId i = stack.back().second;
+
+      if ( i == ( forward ? FaninBegin[p + 1] : FanoutBegin[p + 1] ) ) {
+        order.push_back( p );
+        stack.pop_back();
+        continue;
+      }
+
+      stack.back().second++;
+
+      const NetsInfo& edge = EdgeTable[forward ? FaninEdges[i] : i];
+      PinId next = forward ? edge.fromPin : edge.toPin;
+
+      if ( is_timing_edge( edge ) && PinLevel[next] != INVALID_ID &&
+           !is_done( PinTable[next], forward ) && ConeVisit[next] != ConeStamp ) {
+        ConeVisit[next] = ConeStamp;
+        stack.push_back( std::make_pair( next, forward ? FaninBegin[next] : FanoutBegin[next] ) );
+      }
+    }
+  }
+
+}
+
+/* Time the fanin cones of roots as far as they are out of date */
+static void ensure_arrivals( const vector<PinId>& roots ) {
+
+  vector<PinId> order;
+  collect_cone( roots, true, order );
+
+  for ( auto it = order.begin(); it != order.end(); it++ ) {
+    propagate_pin( *it );
+    PinTable[*it].atValid = true;
+  }
+
+}
+
+/* Required times of the fanout cones of roots. They need the arc delays *
+ * of the cones, so their arrivals, and the clock arrivals of the flip  *
+ * flops they end at.                                                   */
+static void ensure_required( const vector<PinId>& roots ) {
+
+  vector<PinId> order;
+  collect_cone( roots, false, order );
+
+  if ( order.empty() )
+    return;
+
+  vector<PinId> needed( order );
+  for ( auto it = order.begin(); it != order.end(); it++ )
+    if ( InstanceClock[*it] != INVALID_ID )
+      needed.push_back( InstanceClock[*it] );
+
+  ensure_arrivals( needed );
+
+  for ( auto it = order.begin(); it != order.end(); it++ ) {
+    propagate_pin_bwd( *it );
+    PinTable[*it].ratStamp = RequiredStamp;
+  }
+
+}
+
+/* An arrival went out of date, and with it those of its fanout cone. *
+ * A pin that is out of date has its whole fanout cone out of date,   *
+ * so the walk stops there.                                           */
+static void drop_arrivals( PinId p ) {
+
+  RequiredStamp++;
+
+  vector<PinId> stack( 1, p );
+
+  while ( !stack.empty() ) {
+
+    VerParserPinInfo& pin = PinTable[stack.back()];
+    PinId q = stack.back();
+    stack.pop_back();
+
+    if ( !pin.atValid )
+      continue;
+
+    pin.atValid = false;
+
+    for ( EdgeId e = FanoutBegin[q]; e < FanoutBegin[q + 1]; e++ )
+      if ( is_timing_edge( EdgeTable[e] ) )
+        stack.push_back( EdgeTable[e].toPin );
+  }
+
+}
+
+int begin_lazy_timing() {
+
+  levelize();
+  LazyTiming = true;
+
+  for ( PinId p = 0; p < PinTable.size(); p++ ) {
+    VerParserPinInfo& pin = PinTable[p];
+    reset_timing( pin );
+    reset_required( pin );
+    pin.fwdDirty = pin.bwdDirty = pin.atValid = false;
+    pin.ratStamp = 0;
+  }
+
+  for ( auto it = CornerPins.begin(); it != CornerPins.end(); it++ ) {
+    reset_timing( *it );
+    reset_required( *it );
+  }
+
+  FwdDirty.assign( LevelBegin.size() - 1, vector<PinId>() );
+  BwdDirty.assign( LevelBegin.size() - 1, vector<PinId>() );
+  RequiredStamp = 1;
+
+  /* The tree only needs the netlist. Its credits are refreshed from *
+   * the arrivals the queries time.                                  */
+  build_clock_tree();
+
+  return 1;
+
+}
+
+/* The common node of the clocks of a pin's worst path is in the fanin *
+ * cone of its capture clock, which ensure_required has timed.         */
+static void ensure_credit( PinId p, bool rise, bool late ) {
+
+  PinId capture = InstanceClock[p];
+  if ( capture == INVALID_ID || ClockNet.nodeOf.empty() || ClockNet.nodeOf[capture] == INVALID_ID )
+    return;
+
+  PinId launch = launching_clock( p, rise, late );
+  if ( launch == INVALID_ID || ClockNet.nodeOf[launch] == INVALID_ID )
+    return;
+
+  update_clock_credit( ClockNet.pins[clock_lca( ClockNet.nodeOf[launch], ClockNet.nodeOf[capture] )] );
+
+}
+
+void ensure_timing( PinId endpoint ) {
+
+  if ( !LazyTiming )
+    return;
+
+  update_dirty_nets();
+
+  if ( endpoint != INVALID_ID )
+    ensure_required( vector<PinId>( 1, endpoint ) );
+  else
+    ensure_required( LevelPins );
+
+  for ( auto it = ClockNet.pins.begin(); it != ClockNet.pins.end(); it++ )
+    update_clock_credit( *it );
+
+}
+
+double report_at( PinId p, bool rise, bool late ) {
+
+  if ( LazyTiming ) {
+    update_dirty_nets();
+    ensure_arrivals( vector<PinId>( 1, p ) );
+  }
+
+  const VerParserPinInfo& pin = PinTable[p];
+
+  if ( late )
+    return rise ? pin.at_r_late : pin.at_f_late;
+  return rise ? pin.at_r_early : pin.at_f_early;
+
+}
+
+double report_slew( PinId p, bool rise, bool late ) {
+
+  if ( LazyTiming ) {
+    update_dirty_nets();
+    ensure_arrivals( vector<PinId>( 1, p ) );
+  }
+
+  const VerParserPinInfo& pin = PinTable[p];
+
+  if ( late )
+    return rise ? pin.tr_r_late : pin.tr_f_late;
+  return rise ? pin.tr_r_early : pin.tr_f_early;
+
+}
+
+double report_rat( PinId p, bool rise, bool late ) {
+
+  if ( LazyTiming ) {
+    update_dirty_nets();
+    ensure_required( vector<PinId>( 1, p ) );
+  }
+
+  const VerParserPinInfo& pin = PinTable[p];
+
+  if ( late )
+    return rise ? pin.rat_r_late : pin.rat_f_late;
+  return rise ? pin.rat_r_early : pin.rat_f_early;
+
+}
+
+double report_slack( PinId p, bool rise, bool late ) {
+
+  if ( LazyTiming ) {
+    update_dirty_nets();
+    ensure_required( vector<PinId>( 1, p ) );
+    ensure_credit( p, rise, late );
+  }
+
+  return cppr_slack( p, rise, late );
+
+}
+
+double report_slack( PinId p, bool late ) {
+  return std::min( report_slack( p, true, late ), report_slack( p, false, late ) );
+}
+
+static void mark_fwd( PinId p ) {
+
+  VerParserPinInfo& pin = PinTable[p];
+
+  if ( PinLevel[p] == INVALID_ID )
+    return;
+
+  if ( LazyTiming ) {
+    drop_arrivals( p );
+    return;
+  }
+
+  if ( pin.fwdDirty )
+    return;
+
+  pin.fwdDirty = true;
+  FwdDirty[PinLevel[p]].push_back( p );
+
+}
+
+static void mark_bwd( PinId p ) {
 
+  VerParserPinInfo& pin = PinTable[p];
 
+  if ( PinLevel[p] == INVALID_ID )
+    return;
+
+  if ( LazyTiming ) {
+    RequiredStamp++;
+    return;
+  }
+
+  if ( pin.bwdDirty )
+    return;
+
+  pin.bwdDirty = true;
+  BwdDirty[PinLevel[p]].push_back( p );
+
+}
+
+/* The required times of flip flop data pins follow the clock pin *
+ * of the instance, which is not connected to them by an edge.    */
+static void mark_sequential_inputs( const VerParserPinInfo& pin ) {
+
+  const vector<LibParserPinInfo>& cellPins = CellTable[pin.cell]->pins;
+
+  for ( auto it = cellPins.begin(); it != cellPins.end(); it++ )
+    if ( it->isInput ) {
+      PinId input = PinNames.find( pin.instance_name + it->name );
+      if ( input != INVALID_ID )
+        mark_bwd( input );
+    }
+
+}
+
+/* Values re-timing a pin writes at one corner: its arrivals and slews *
+ * and the delays of its fanin arcs                                    */
+template <class CORNER, class OP>
+static void arrival_values( const CORNER& corner, PinId p, OP& op ) {
+
+  auto& pin = corner.timing( p );
+
+  op( pin.at_r_early ); op( pin.at_f_early ); op( pin.at_r_late ); op( pin.at_f_late );
+  op( pin.tr_r_early ); op( pin.tr_f_early ); op( pin.tr_r_late ); op( pin.tr_f_late );
+
+  for ( EdgeId i = FaninBegin[p]; i < FaninBegin[p + 1]; i++ ) {
+    if ( EdgeTable[FaninEdges[i]].net != INVALID_ID )
+      continue;
+    auto& arc = corner.delays( FaninEdges[i] );
+    op( arc.dr_EARLY ); op( arc.df_EARLY ); op( arc.dr_LATE ); op( arc.df_LATE );
+  }
+
+}
+
+/* Required times re-timing a pin writes at one corner */
+template <class CORNER, class OP>
+static void required_values( const CORNER& corner, PinId p, OP& op ) {
+
+  auto& pin = corner.timing( p );
+
+  op( pin.rat_r_early ); op( pin.rat_f_early ); op( pin.rat_r_late ); op( pin.rat_f_late );
+
+}
+
+template <bool FORWARD, class OP>
+static void pin_values( PinId p, OP& op ) {
+
+  if constexpr ( FORWARD )
+    arrival_values( PrimaryCorner(), p, op );
+  else
+    required_values( PrimaryCorner(), p, op );
+
+  for ( unsigned int k = 0; k < Corners.size(); k++ ) {
+    if constexpr ( FORWARD )
+      arrival_values( ExtraCorner( k ), p, op );
+    else
+      required_values( ExtraCorner( k ), p, op );
+  }
+
+}
+
+/* Unconstrained and untimed values are +-max, which only match themselves */
+static inline bool moved( double before, double after ) {
+  return before != after && !( std::fabs( after - before ) <= TimingEpsilon );
+}
+
+/* Snapshot of the values of a level of pins before they are re-timed. *
+ * Pin i has values[begin[i] .. begin[i+1]-1].                         */
+struct PinSnapshot {
+
+  vector<double> values;
+  vector<size_t> begin;
+
+  template <bool FORWARD>
+  void save( const vector<PinId>& pins ) {
+
+    auto push = [this] ( double& x ) { values.push_back( x ); };
+
+    values.clear();
+    begin.assign( 1, 0 );
+
+    for ( auto it = pins.begin(); it != pins.end(); it++ ) {
+      pin_values<FORWARD>( *it, push );
+      begin.push_back( values.size() );
+    }
+
+  }
+
+  /* Did any value move by more than TimingEpsilon */
+  template <bool FORWARD>
+  bool changed( size_t i, PinId p ) const {
+
+    const double* v = &values[begin[i]];
+    bool any = false;
+    auto test = [&v, &any] ( double& x ) { any |= moved( *v++, x ); };
+
+    pin_values<FORWARD>( p, test );
+    return any;
+
+  }
+
+  /* Put back everything re-timing the pin wrote */
+  template <bool FORWARD>
+  void restore( size_t i, PinId p ) const {
+
+    const double* v = &values[begin[i]];
+    auto put = [&v] ( double& x ) { x = *v++; };
+
+    pin_values<FORWARD>( p, put );
+
+  }
+
+};
+
+/* The load of the driver and the wire delay to every sink change */
+void invalidate_net( NetId net ) {
+
+  /* The rebuild re-times everything */
+  if ( TopologyDirty )
+    return;
+
+  if ( net == INVALID_ID || NetTable[net].dirty )
+    return;
+
+  NetTable[net].dirty = true;
+  DirtyNets.push_back( net );
+
+  PinId driver = NetTable[net].driver;
+  if ( driver == INVALID_ID )
+    return;
+
+  mark_fwd( driver );
+  for ( EdgeId e = FanoutBegin[driver]; e < FanoutBegin[driver + 1]; e++ )
+    mark_fwd( EdgeTable[e].toPin );
+
+}
+
+void invalidate_pin( PinId pin ) {
+
+  if ( TopologyDirty )
+    return;
+
+  mark_fwd( pin );
+  mark_bwd( pin );
+
+}
+
+int repower_gate( const string& instance, const string& cellType ) {
+
+  CellId cell = CellNames.find( cellType );
+  if ( cell == INVALID_ID )
+    return 0;
+
+  const LibParserCellInfo& info = *CellTable[cell];
+  vector<PinId> pins;
+
+  for ( auto it = info.pins.begin(); it != info.pins.end(); it++ ) {
+    PinId p = PinNames.find( instance + it->name );
+    if ( p != INVALID_ID && PinTable[p].cell != INVALID_ID && PinTable[p].instance_name == instance )
+      pins.push_back( p );
+  }
+
+  if ( pins.empty() )
+    return 0;
+
+  /* Every pin of the instance must be on the new cell */
+  const vector<LibParserPinInfo>& oldPins = CellTable[PinTable[pins[0]].cell]->pins;
+
+  for ( auto it = oldPins.begin(); it != oldPins.end(); it++ )
+    if ( PinNames.find( instance + it->name ) != INVALID_ID && info.find_pin( it->name ) == nullptr )
+      return 0;
+
+  for ( auto it = pins.begin(); it != pins.end(); it++ ) {
+    PinTable[*it].cell = cell;
+    PinTable[*it].libPin = info.find_pin( PinTable[*it].pinName );
+  }
+
+  /* The edges and the checks are redone by the rebuild */
+  if ( TopologyDirty )
+    return 1;
+
+  for ( auto it = pins.begin(); it != pins.end(); it++ )
+    resolve_checks( *it );
+
+  for ( auto it = pins.begin(); it != pins.end(); it++ ) {
+
+    VerParserPinInfo& pin = PinTable[*it];
+
+    for ( EdgeId i = FaninBegin[*it]; i < FaninBegin[*it + 1]; i++ ) {
+      NetsInfo& edge = EdgeTable[FaninEdges[i]];
+      if ( edge.net == INVALID_ID )
+        edge.arc = find_arc( cell, PinTable[edge.fromPin].pinName, pin.pinName );
+    }
+
+    /* The input caps are part of the load on the driving nets */
+    if ( pin.isInput )
+      invalidate_net( pin.net );
+    invalidate_pin( *it );
+  }
+
+  return 1;
+
+}
+
+/* Drivers of a net: cell outputs and primary input ports */
+static bool is_driver( PinId p ) {
+
+  const VerParserPinInfo& pin = PinTable[p];
+  return ( pin.cell == INVALID_ID ) ? PIs.count( PinNames.name(p) ) > 0 : !pin.isInput;
+
+}
+
+/* The pins of an instance, by the pins of its cell. The cell is *
+ * found from whichever library pin name the instance has.       */
+static void instance_pins( const string& instance, vector<PinId>& pins ) {
+
+  CellId cell = INVALID_ID;
+
+  pins.clear();
+
+  for ( CellId c = 0; c < CellTable.size() && cell == INVALID_ID; c++ )
+    for ( auto it = CellTable[c]->pins.begin(); it != CellTable[c]->pins.end(); it++ ) {
+      PinId p = PinNames.find( instance + it->name );
+      if ( p != INVALID_ID && PinTable[p].instance_name == instance ) {
+        cell = PinTable[p].cell;
+        break;
+      }
+    }
+
+  if ( cell == INVALID_ID )
+    return;
+
+  for ( auto it = CellTable[cell]->pins.begin(); it != CellTable[cell]->pins.end(); it++ ) {
+    PinId p = PinNames.find( instance + it->name );
+    if ( p != INVALID_ID )
+      pins.push_back( p );
+  }
+
+}
+
+int insert_gate( const string& instance, const string& cellType ) {
+
+  CellId cell = CellNames.find( cellType );
+  if ( cell == INVALID_ID )
+    return 0;
+
+  const LibParserCellInfo& info = *CellTable[cell];
+
+  for ( auto it = info.pins.begin(); it != info.pins.end(); it++ )
+    if ( PinNames.find( instance + it->name ) != INVALID_ID )
+      return 0;
+
+  /* Pins as the verilog reader makes them */
+  for ( auto it = info.pins.begin(); it != info.pins.end(); it++ ) {
+
+    PinTable.resize( PinNames.intern( instance + it->name ) + 1 );
+
+    VerParserPinInfo& pin = PinTable.back();
+    pin.isInput = it->isInput;
+    pin.cell = cell;
+    pin.libPin = &*it;
+    pin.instance_name = instance;
+    pin.pinName = it->name;
+    pin.tr_r_early = std::numeric_limits<double>::max();
+    pin.tr_f_early = std::numeric_limits<double>::max();
+    pin.tr_r_late = std::numeric_limits<double>::lowest();
+    pin.tr_f_late = std::numeric_limits<double>::lowest();
+  }
+
+  /* In-cell connections from the inputs and the clock to the outputs */
+  for ( auto it = info.timingArcs.begin(); it != info.timingArcs.end(); it++ ) {
+
+    const LibParserPinInfo* from = info.find_pin( it->fromPin );
+    const LibParserPinInfo* to = info.find_pin( it->toPin );
+
+    if ( from != nullptr && to != nullptr && ( from->isInput || from->isClock ) && !to->isInput )
+      add_edge( PinNames.find( instance + it->fromPin ), PinNames.find( instance + it->toPin ),
+                INVALID_ID, find_arc( cell, it->fromPin, it->toPin ) );
+  }
+
+  TopologyDirty = true;
+  return 1;
+
+}
+
+int remove_gate( const string& instance ) {
+
+  vector<PinId> pins;
+  instance_pins( instance, pins );
+
+  if ( pins.empty() )
+    return 0;
+
+  /* The pin rows stay, without a name, a cell or any edge */
+  for ( auto it = pins.begin(); it != pins.end(); it++ ) {
+    disconnect_pin( *it );
+    PinNames.erase( PinNames.name(*it) );
+    PinTable[*it] = VerParserPinInfo();
+    RemovedPins.push_back( *it );
+  }
+
+  TopologyDirty = true;
+  return 1;
+
+}
+
+int insert_net( const string& net ) {
+
+  if ( NetNames.find( net ) != INVALID_ID )
+    return 0;
+
+  NetTable.resize( NetNames.intern( net ) + 1 );
+
+  auto spef = SpefNets.find( net );
+  NetTable.back().spef = ( spef == SpefNets.end() ) ? nullptr : &spef->second;
+
+  TopologyDirty = true;
+  return 1;
+
+}
+
+int remove_net( const string& net ) {
+
+  NetId n = NetNames.find( net );
+  if ( n == INVALID_ID || NetTable[n].isPrimaryIn || NetTable[n].isPrimaryOut )
+    return 0;
+
+  for ( PinId p = 0; p < PinTable.size(); p++ )
+    if ( PinTable[p].net == n )
+      disconnect_pin( p );
+
+  NetNames.erase( net );
+  NetTable[n] = GraphNet();
+
+  TopologyDirty = true;
+  return 1;
+
+}
+
+int connect_pin( PinId pin, const string& net ) {
+
+  NetId n = NetNames.find( net );
+  if ( pin == INVALID_ID || n == INVALID_ID )
+    return 0;
+
+  /* A net has one driver */
+  if ( is_driver( pin ) && NetTable[n].driver != INVALID_ID && NetTable[n].driver != pin )
+    return 0;
+
+  if ( PinTable[pin].net != INVALID_ID )
+    disconnect_pin( pin );
+
+  if ( is_driver( pin ) )
+    NetTable[n].driver = pin;
+
+  PinTable[pin].net = n;
+  PinTable[pin].connNetName = net;
+  RewiredNets.push_back( n );
+
+  TopologyDirty = true;
+  return 1;
+
+}
+
+int disconnect_pin( PinId pin ) {
+
+  if ( pin == INVALID_ID || PinTable[pin].net == INVALID_ID )
+    return 0;
+
+  NetId n = PinTable[pin].net;
+
+  if ( NetTable[n].driver == pin )
+    NetTable[n].driver = INVALID_ID;
+
+  PinTable[pin].net = INVALID_ID;
+  PinTable[pin].connNetName.clear();
+  RewiredNets.push_back( n );
+
+  TopologyDirty = true;
+  return 1;
+
+}
+
+/* Apply the netlist edits: the rewired nets get their driver -> sink *
+ * edges again, the in-cell edges the arcs of their cells, and then  *
+ * the graph is indexed as create_graph does it.                     */
+static void rebuild_graph() {
+
+  vector<char> rewired( NetTable.size(), 0 );
+  vector<char> removed( PinTable.size(), 0 );
+
+  for ( auto it = RewiredNets.begin(); it != RewiredNets.end(); it++ )
+    rewired[*it] = 1;
+
+  for ( auto it = RemovedPins.begin(); it != RemovedPins.end(); it++ )
+    removed[*it] = 1;
+
+  EdgeTable.erase( std::remove_if( EdgeTable.begin(), EdgeTable.end(), [&] ( const NetsInfo& edge ) {
+    return ( edge.net != INVALID_ID && rewired[edge.net] ) || removed[edge.fromPin] || removed[edge.toPin];
+  } ), EdgeTable.end() );
+
+  /* Repowered cells may have other arcs */
+  for ( auto it = EdgeTable.begin(); it != EdgeTable.end(); it++ )
+    if ( it->net == INVALID_ID )
+      it->arc = find_arc( PinTable[it->fromPin].cell, PinTable[it->fromPin].pinName, PinTable[it->toPin].pinName );
+
+  for ( PinId p = 0; p < PinTable.size(); p++ ) {
+    NetId n = PinTable[p].net;
+    if ( n != INVALID_ID && rewired[n] && NetTable[n].driver != INVALID_ID && NetTable[n].driver != p )
+      add_edge( NetTable[n].driver, p, n, INVALID_ID );
+  }
+
+  build_csr();
+  renumber_graph();
+  index_corners();
+
+  for ( NetId net = 0; net < NetTable.size(); net++ ) {
+    SpefNet* spef = NetTable[net].spef;
+    if ( spef != nullptr && !spef->isReduced )
+      index_spef_net( *spef );
+    update_net( net );
+    NetTable[net].dirty = false;
+  }
+
+  index_sequential();
+
+  DirtyNets.clear();
+  RewiredNets.clear();
+  RemovedPins.clear();
+  TopologyDirty = false;
+
+}
+
+/* Re-time the dirty pins. The forward sweep goes down the levels and *
+ * marks the fanout of every pin whose arrival changed. A re-timed pin *
+ * also rewrote its fanin edges, so it and its fanin pins get their    *
+ * required times redone by the backward sweep, which goes up the      *
+ * levels the same way. The pins of a level run on the worker pool.    */
+int update_timing() {
+
+  ThreadPool& pool = thread_pool();
+  PinSnapshot before;
+
+  /* A new netlist is timed from scratch */
+  if ( TopologyDirty ) {
+
+    rebuild_graph();
+
+    if ( LazyTiming )
+      return begin_lazy_timing();
+
+    find_nets_delay();
+    return bfs_on_graph_bwd();
+  }
+
+  update_dirty_nets();
+
+  /* The queries re-time what they need */
+  if ( LazyTiming )
+    return 1;
+
+  for ( unsigned int level = 0; level < FwdDirty.size(); level++ ) {
+
+    vector<PinId>& pins = FwdDirty[level];
+    if ( pins.empty() )
+      continue;
+
+    before.save<true>( pins );
+
+    const PinId* first = pins.data();
+    pool.parallel_for( pins.size(), [first] ( size_t i ) {
+      propagate_pin( first[i] );
+    }, PROPAGATE_GRAIN );
+
+    for ( size_t i = 0; i < pins.size(); i++ ) {
+
+      PinId p = pins[i];
+      VerParserPinInfo& pin = PinTable[p];
+
+      pin.fwdDirty = false;
+      mark_bwd( p );
+
+      for ( EdgeId j = FaninBegin[p]; j < FaninBegin[p + 1]; j++ )
+        if ( is_timing_edge( EdgeTable[FaninEdges[j]] ) )
+          mark_bwd( EdgeTable[FaninEdges[j]].fromPin );
+
+      if ( !before.changed<true>( i, p ) ) {
+        before.restore<true>( i, p );
+        continue;
+      }
+
+      for ( EdgeId e = FanoutBegin[p]; e < FanoutBegin[p + 1]; e++ )
+        if ( is_timing_edge( EdgeTable[e] ) )
+          mark_fwd( EdgeTable[e].toPin );
+
+      if ( pin.cell != INVALID_ID && CellTable[pin.cell]->isSequential )
+        mark_sequential_inputs( pin );
+
+      update_clock_credit( p );
+    }
+
+    pins.clear();
+  }
+
+  for ( unsigned int level = BwdDirty.size(); level-- > 0; ) {
+
+    vector<PinId>& pins = BwdDirty[level];
+    if ( pins.empty() )
+      continue;
+
+    before.save<false>( pins );
+
+    const PinId* first = pins.data();
+    pool.parallel_for( pins.size(), [first] ( size_t i ) {
+      propagate_pin_bwd( first[i] );
+    }, PROPAGATE_GRAIN );
+
+    for ( size_t i = 0; i < pins.size(); i++ ) {
+
+      PinId p = pins[i];
+      VerParserPinInfo& pin = PinTable[p];
+
+      pin.bwdDirty = false;
+
+      if ( !before.changed<false>( i, p ) ) {
+        before.restore<false>( i, p );
+        compute_slack( pin );
+        for ( unsigned int k = 0; k < Corners.size(); k++ )
+          compute_slack( ExtraCorner( k ).timing( p ) );
+        continue;
+      }
+
+      for ( EdgeId j = FaninBegin[p]; j < FaninBegin[p + 1]; j++ )
+        if ( is_timing_edge( EdgeTable[FaninEdges[j]] ) )
+          mark_bwd( EdgeTable[FaninEdges[j]].fromPin );
+    }
+
+    pins.clear();
+  }
+
+  return 1;
 
 }
@@ -1,11 +1,179 @@
 #ifndef _GRAPH_H
 #define _GRAPH_H
 #define NUM_OF_COLORS 13
+#define PROPAGATE_GRAIN 64 // pins per task of a parallel level
 
+#include "parser_helper.h"
+#include "interner.h"
+
+/* Net of the timing graph, indexed by NetId */
+struct GraphNet {
+
+  SpefNet* spef; // parasitics, nullptr if the net is not in the spef file
+  PinId driver; // INVALID_ID if the net has no driver
+  bool isPrimaryIn;
+  bool isPrimaryOut;
+  bool dirty; // changed since the last update_timing
+  double load; // pin caps of the sinks plus the wire cap, kept up to date by update_timing
+
+  GraphNet () : spef (nullptr), driver (INVALID_ID), isPrimaryIn (false), isPrimaryOut (false), dirty (false), load (0.0) {}
+
+};
+
+/* Id tables, built by create_graph. Names are only looked up while *
+ * the graph is built; from then on everything is indexed by id.    */
+extern NameInterner PinNames;   // instance name + pin name, port name for ports
+extern NameInterner NetNames;
+extern NameInterner CellNames;
+extern vector<VerParserPinInfo> PinTable;         // by PinId
+extern vector<GraphNet> NetTable;                 // by NetId
+extern vector<NetsInfo> EdgeTable;                // by EdgeId
+extern vector<LibParserCellInfo*> CellTable;      // by CellId
+extern vector<LibParserTimingInfo*> ArcTable;     // by ArcId
+extern vector<PinId> PrimaryInputs;
+extern vector<PinId> PrimaryOutputs;
+extern vector<PinId> InstanceClock;               // by PinId, clock pin of its flip flop or INVALID_ID
+
+/* Timing of a pin at an extra corner, named as the fields of *
+ * VerParserPinInfo, which hold the primary corner.           */
+struct CornerTiming {
+
+  double at_r_early, at_f_early, at_r_late, at_f_late;
+  double rat_r_early, rat_f_early, rat_r_late, rat_f_late;
+  double slack_early, slack_late;
+  double tr_r_early, tr_f_early, tr_r_late, tr_f_late;
+
+};
+
+/* Delays of an edge at an extra corner, named as in NetsInfo */
+struct CornerDelay {
+
+  double delay;
+  double dr_EARLY, df_EARLY, dr_LATE, df_LATE;
+
+  CornerDelay () : delay (0.0), dr_EARLY (0.0), df_EARLY (0.0), dr_LATE (0.0), df_LATE (0.0) {}
+
+};
+
+/* Library and parasitics of an extra corner. The netlist and the  *
+ * assertions are shared with the primary corner, which is the one *
+ * in the tables above; a corner only brings its cells and wires.  */
+struct Corner {
+
+  std::unordered_map<string, LibParserCellInfo> cells;
+  std::unordered_map<string, SpefNet> spefNets;
+  vector<LibParserCellInfo*> cellTable;     // by CellId
+  vector<LibParserTimingInfo*> arcTable;    // by ArcId
+  vector<SpefNet*> spef;                    // by NetId, nullptr if the net is not in its spef file
+  vector<double> load;                      // by NetId
+
+};
+
+/* All corners are timed by the same passes, the values of the extra *
+ * ones for a pin or an edge side by side. CPPR, the path reports    *
+ * and the queries are on the primary corner. Incremental timing     *
+ * stops where no corner changes any more.                           */
+extern vector<Corner> Corners;            // extra corners, the primary one not included
+extern vector<CornerTiming> CornerPins;   // by PinId * Corners.size() + corner
+extern vector<CornerDelay> CornerEdges;   // by EdgeId * Corners.size() + corner
+
+/* Compressed sparse row adjacency, built once by create_graph.      *
+ * EdgeTable is sorted by source pin, so the fanout edges of pin p   *
+ * are the ids FanoutBegin[p] .. FanoutBegin[p+1]-1. The fanin edges *
+ * of p are FaninEdges[FaninBegin[p]] .. FaninEdges[FaninBegin[p+1]-1]. */
+extern vector<EdgeId> FanoutBegin;
+extern vector<EdgeId> FaninBegin;
+extern vector<EdgeId> FaninEdges;
+
+/* Topological levels, built by levelize. A pin is on the level after *
+ * the deepest of its fanins, so every level only depends on earlier  *
+ * ones. The pins of level l are LevelPins[LevelBegin[l]] ..          *
+ * LevelPins[LevelBegin[l+1]-1]. Pins on a combinational loop get no  *
+ * level (INVALID_ID) and are not timed.                              */
+extern vector<unsigned int> PinLevel;
+extern vector<PinId> LevelPins;
+extern vector<PinId> LevelBegin;
+
+/* Only these edges carry timing. In-cell connections without a *
+ * library arc (d -> q of a flip flop) do not, which also cuts   *
+ * the loops through sequential cells.                           */
+inline bool is_timing_edge( const NetsInfo& edge ) {
+  return edge.net != INVALID_ID || edge.arc != INVALID_ID;
+}
+
+/* A pin some path reached. Untimed pins keep their early arrival at +max */
+template <class TIMING>
+inline bool is_timed( const TIMING& pin ) {
+  return pin.at_r_early != std::numeric_limits<double>::max();
+}
+
+/* Read the library and parasitics of an extra corner, before create_graph */
+int load_corner( const string& libFile, const string& spefFile );
 
 int create_graph();
+int levelize();
 int find_nets_delay();
 int bfs_on_graph_bwd();
 int print_graph();
 
+/* Incremental timing. An edit marks what it changed and update_timing   *
+ * re-times only the fanout cone of the pins whose arrival changed and   *
+ * the fanin cone of the pins whose required time changed. Everything    *
+ * else keeps its values from the last pass. The netlist edits below    *
+ * are the exception, they have the next update_timing start over.      */
+void invalidate_net( NetId net );  // parasitics or sink pin caps changed
+void invalidate_pin( PinId pin );  // assertion or library arcs of the pin changed
+int update_timing();
+
+/* A re-timed pin goes no further if nothing re-timing it wrote moved  *
+ * by more than TimingEpsilon at any corner: its arrivals, slews and    *
+ * fanin arc delays, or its required times on the way back. All of it  *
+ * is put back, so its fanout and fanin stay timed with the values it   *
+ * has, each within TimingEpsilon of what its fanin gives it. The error *
+ * can add up along a path. 0 stops only on pins where nothing changed, *
+ * which gives the same values as the full passes.                      */
+extern double TimingEpsilon;
+
+/* Swap the library cell of an instance for one with the same pins and *
+ * invalidate what that changes. The in-cell edges take the arcs of    *
+ * the new cell; arcs the old cell did not have are not added, since   *
+ * the topology stays. Returns 0 if the instance or the cell is not    *
+ * known or their pins do not match.                                   */
+int repower_gate( const string& instance, const string& cellType );
+
+/* Netlist edits. They change the pin and net tables right away and  *
+ * leave the rest to the next update_timing, which rebuilds the      *
+ * edges, the CSR, the levels and the ids once for all of them and   *
+ * re-times the whole design, or starts the lazy mode over. Nothing  *
+ * may be reported before that, and ids must be looked up again      *
+ * after it. A removed pin or net keeps its row but loses its name.  *
+ * Each returns 0 if a name is not known or already taken, or if the *
+ * edit would give a net a second driver.                            */
+int insert_gate( const string& instance, const string& cellType );  // its pins are not connected
+int remove_gate( const string& instance );                          // disconnects its pins first
+int insert_net( const string& net );
+int remove_net( const string& net );                                // not a port net, disconnects its pins first
+int connect_pin( PinId pin, const string& net );
+int disconnect_pin( PinId pin );
+
+/* Lazy timing, for tools that only ask about a few pins. Instead of   *
+ * the full passes, begin_lazy_timing levelizes and leaves every pin   *
+ * out of date. A query then times only the cone it needs: the fanin   *
+ * cone for an arrival, the fanout cone and what that depends on for a *
+ * slack. What it computed stays up to date for later queries until an *
+ * invalidate_* call drops it. find_nets_delay ends the lazy mode; out *
+ * of it the queries read the values of the last pass. A CPPR credit   *
+ * is refreshed by the slack query that needs it.                      */
+int begin_lazy_timing();
+
+/* Bring everything a path report into endpoint reads up to date, or  *
+ * all of the design without an endpoint. Does nothing out of the    *
+ * lazy mode.                                                        */
+void ensure_timing( PinId endpoint = INVALID_ID );
+double report_at( PinId pin, bool rise, bool late );
+double report_slew( PinId pin, bool rise, bool late );
+double report_rat( PinId pin, bool rise, bool late );
+double report_slack( PinId pin, bool rise, bool late );   // with the CPPR credit, +max if unconstrained
+double report_slack( PinId pin, bool late );              // worst of rise and fall
+
 #endif
@@ -0,0 +1,47 @@
+#include "interner.h"
+
+uint32_t NameInterner::intern( std::string_view name ) {
+
+  auto it = ids.find(name);
+  if ( it != ids.end() )
+    return it->second;
+
+  /* deque never moves its elements, so the view stays valid */
+  uint32_t id = names.size();
+  if ( !slot.empty() )
+    slot.push_back( names.size() );
+  names.emplace_back(name);
+  ids.emplace( std::string_view(names.back()), id );
+
+  return id;
+
+}
+
+uint32_t NameInterner::find( std::string_view name ) const {
+
+  auto it = ids.find(name);
+  return it == ids.end() ? INVALID_ID : it->second;
+
+}
+
+void NameInterner::renumber( const std::vector<uint32_t>& newId ) {
+
+  std::vector<uint32_t> moved( names.size() );
+
+  for ( uint32_t id = 0; id < names.size(); id++ )
+    moved[newId[id]] = slot.empty() ? id : slot[id];
+
+  slot.swap( moved );
+
+  for ( auto it = ids.begin(); it != ids.end(); ++it )
+    it->second = newId[it->second];
+
+}
+
+void NameInterner::clear() {
+
+  ids.clear();
+  names.clear();
+  slot.clear();
+
+}
@@ -0,0 +1,53 @@
+#ifndef _INTERNER_H
+#define _INTERNER_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <deque>
+#include <vector>
+#include <unordered_map>
+
+/* Dense integer ids of the timing graph. Names are turned into ids  *
+ * once, while the graph is built; the timing code only uses the ids. */
+typedef uint32_t PinId;
+typedef uint32_t NetId;
+typedef uint32_t ArcId;
+typedef uint32_t CellId;
+typedef uint32_t EdgeId;
+
+const uint32_t INVALID_ID = UINT32_MAX;
+
+/* Maps names to consecutive ids starting from 0, and ids back to names. *
+ * Every name is stored once; the hash table keys point into it.         */
+class NameInterner {
+
+  std::deque<std::string> names;                     // in the order they were interned
+  std::vector<uint32_t> slot;                        // by id, index into names; empty until renumber
+  std::unordered_map<std::string_view, uint32_t> ids;
+
+public:
+
+  /* Id of the name. A name seen for the first time gets the next id */
+  uint32_t intern( std::string_view name );
+
+  /* Id of the name or INVALID_ID if it was never interned */
+  uint32_t find( std::string_view name ) const;
+
+  /* Forget a name. Its id keeps it, but find no longer sees it *
+   * and interning it again gives a new id.                     */
+  void erase( std::string_view name ) { ids.erase(name); }
+
+  const std::string& name( uint32_t id ) const { return names[slot.empty() ? id : slot[id]]; }
+  uint32_t size() const { return names.size(); }
+
+  /* Give every name the id newId[id]. The names stay where they *
+   * are; only the ids in the hash table and the slot table move. */
+  void renumber( const std::vector<uint32_t>& newId );
+
+  void reserve( size_t count ) { ids.reserve(count); }
+  void clear();
+
+};
+
+#endif
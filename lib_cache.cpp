@@ -0,0 +1,333 @@
+#include <cstring>
+#include <cstdio>
+#include <cstdint>
+#include <cerrno>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "parser_helper.h"
+#include "lib_cache.h"
+
+bool UseLibCache = true ;
+
+// Bump the version whenever the layout below changes
+static const char CacheMagic[8] = {'C', 'H', 'R', 'L', 'I', 'B', '0', '2'} ;
+
+// File layout. All integers are uint64, all reals are doubles,
+// strings are a length followed by the characters.
+//
+//   magic, source size, source mtime (ns), number of cells
+//   per cell:
+//     name, footprint, leakagePower, area, isSequential, dontTouch
+//     number of pins, per pin:
+//       name, capacitance, maxCapacitance, isInput, isClock
+//     number of arcs, per arc:
+//       fromPin, toPin, timingSense, timingType,
+//       fallDelay, riseDelay, fallTransition, riseTransition,
+//       fallConstraint, riseConstraint
+//   per LUT:
+//     size1, size2, loadIndices[size1], transitionIndices[size2],
+//     tableVals[size1 * size2] (row by row)
+
+struct CacheStamp {
+  uint64_t size ;
+  uint64_t mtime ;
+} ;
+
+static bool source_stamp (string libfile, CacheStamp& stamp) {
+
+  struct stat st ;
+  if (stat (libfile.c_str(), &st) != 0)
+    return false ;
+
+  stamp.size = st.st_size ;
+  stamp.mtime = (uint64_t) st.st_mtim.tv_sec * 1000000000ull + st.st_mtim.tv_nsec ;
+  return true ;
+}
+
+
+/////////////////////////////////////////////////////////////////////
+// Writer
+
+class CacheWriter {
+
+  string buffer ;
+
+public:
+
+  void put (uint64_t v) { buffer.append ((const char*) &v, sizeof(v)) ; }
+  void put (double v) { buffer.append ((const char*) &v, sizeof(v)) ; }
+  void put (bool v) { put ((uint64_t) v) ; }
+
+  void put (const string& s) {
+    put ((uint64_t) s.size()) ;
+    buffer.append (s) ;
+  }
+
+  void put (const vector<double>& v) {
+    buffer.append ((const char*) v.data(), v.size() * sizeof(double)) ;
+  }
+
+  void put (const LibParserLUT& lut) {
+    put ((uint64_t) lut.loadIndices.size()) ;
+    put ((uint64_t) lut.transitionIndices.size()) ;
+    put (lut.loadIndices) ;
+    put (lut.transitionIndices) ;
+    for (int i=0; i < lut.tableVals.size(); ++i)
+      put (lut.tableVals[i]) ;
+  }
+
+  void put_raw (const char* data, size_t size) { buffer.append (data, size) ; }
+
+  const string& data () const { return buffer ; }
+
+} ;
+
+
+string lib_cache_name (string libfile) {
+
+  return libfile + ".cache" ;
+}
+
+bool write_lib_cache (string libfile) {
+
+  CacheStamp stamp ;
+  if (!source_stamp (libfile, stamp))
+    return false ;
+
+  CacheWriter w ;
+  w.put_raw (CacheMagic, sizeof(CacheMagic)) ;
+  w.put (stamp.size) ;
+  w.put (stamp.mtime) ;
+  w.put ((uint64_t) Cells.size()) ;
+
+  for (auto it = Cells.begin(); it != Cells.end(); ++it) {
+
+    const LibParserCellInfo& cell = it->second ;
+    w.put (cell.name) ;
+    w.put (cell.footprint) ;
+    w.put (cell.leakagePower) ;
+    w.put (cell.area) ;
+    w.put (cell.isSequential) ;
+    w.put (cell.dontTouch) ;
+
+    w.put ((uint64_t) cell.pins.size()) ;
+    for (int i=0; i < cell.pins.size(); ++i) {
+      const LibParserPinInfo& pin = cell.pins[i] ;
+      w.put (pin.name) ;
+      w.put (pin.capacitance) ;
+      w.put (pin.maxCapacitance) ;
+      w.put (pin.isInput) ;
+      w.put (pin.isClock) ;
+    }
+
+    w.put ((uint64_t) cell.timingArcs.size()) ;
+    for (int i=0; i < cell.timingArcs.size(); ++i) {
+      const LibParserTimingInfo& arc = cell.timingArcs[i] ;
+      w.put (arc.fromPin) ;
+      w.put (arc.toPin) ;
+      w.put (arc.timingSense) ;
+      w.put (arc.timingType) ;
+      w.put (arc.fallDelay) ;
+      w.put (arc.riseDelay) ;
+      w.put (arc.fallTransition) ;
+      w.put (arc.riseTransition) ;
+      w.put (arc.fallConstraint) ;
+      w.put (arc.riseConstraint) ;
+    }
+  }
+
+  // Write to a temporary file of our own in the same directory and rename
+  // it, so that a concurrent run never maps a half written cache and two
+  // runs writing at once never share a file.
+  string cacheName = lib_cache_name (libfile) ;
+  string tmpName = cacheName + ".XXXXXX" ;
+
+  int fd = mkstemp (&tmpName[0]) ;
+  if (fd < 0)
+    return false ;
+
+  const char* data = w.data().data() ;
+  size_t left = w.data().size() ;
+
+  while (left > 0) {
+    ssize_t written = write (fd, data, left) ;
+    if (written < 0 && errno == EINTR)
+      continue ;
+    if (written <= 0) {
+      close (fd) ;
+      unlink (tmpName.c_str()) ;
+      return false ;
+    }
+    data += written ;
+    left -= written ;
+  }
+
+  // mkstemp creates the file 0600, give the cache the usual 0644
+  fchmod (fd, 0644) ;
+
+  if (close (fd) != 0) {
+    unlink (tmpName.c_str()) ;
+    return false ;
+  }
+
+  if (std::rename (tmpName.c_str(), cacheName.c_str()) != 0) {
+    unlink (tmpName.c_str()) ;
+    return false ;
+  }
+
+  return true ;
+}
+
+
+/////////////////////////////////////////////////////////////////////
+// Reader
+
+class CacheReader {
+
+  const char* curr ;
+  const char* last ;
+  bool ok ;
+
+  bool take (void* dst, size_t size) {
+    if (!ok || (size_t) (last - curr) < size) {
+      ok = false ;
+      return false ;
+    }
+    memcpy (dst, curr, size) ;
+    curr += size ;
+    return true ;
+  }
+
+public:
+
+  CacheReader (const char* begin, const char* end) : curr (begin), last (end), ok (true) {}
+
+  bool good () const { return ok ; }
+
+  // A count read from the file can not be larger than the bytes left
+  bool fits (uint64_t count) {
+    if ((size_t) (last - curr) < count)
+      ok = false ;
+    return ok ;
+  }
+  bool at_end () const { return curr == last ; }
+
+  uint64_t get_uint () { uint64_t v = 0 ; take (&v, sizeof(v)) ; return v ; }
+  double get_double () { double v = 0.0 ; take (&v, sizeof(v)) ; return v ; }
+  bool get_bool () { return get_uint() != 0 ; }
+
+  void get (string& s) {
+    uint64_t size = get_uint() ;
+    if (!ok || (size_t) (last - curr) < size) {
+      ok = false ;
+      return ;
+    }
+    s.assign (curr, size) ;
+    curr += size ;
+  }
+
+  void get (vector<double>& v, uint64_t size) {
+    if (!ok || (size_t) (last - curr) / sizeof(double) < size) {
+      ok = false ;
+      return ;
+    }
+    v.resize (size) ;
+    take (v.data(), size * sizeof(double)) ;
+  }
+
+  void get (LibParserLUT& lut) {
+    uint64_t size1 = get_uint() ;
+    uint64_t size2 = get_uint() ;
+    get (lut.loadIndices, size1) ;
+    get (lut.transitionIndices, size2) ;
+    lut.tableVals.resize (fits (size1) ? size1 : 0) ;
+    for (uint64_t i=0; ok && i < size1; ++i)
+      get (lut.tableVals[i], size2) ;
+  }
+
+  bool check_magic () {
+    char magic[sizeof(CacheMagic)] ;
+    return take (magic, sizeof(magic)) && memcmp (magic, CacheMagic, sizeof(magic)) == 0 ;
+  }
+
+} ;
+
+
+bool read_lib_cache (string libfile) {
+
+  if (!UseLibCache)
+    return false ;
+
+  CacheStamp stamp ;
+  if (!source_stamp (libfile, stamp))
+    return false ;
+
+  MappedFile file (lib_cache_name (libfile)) ;
+  if (!file.is_open())
+    return false ;
+
+  CacheReader r (file.begin(), file.end()) ;
+
+  if (!r.check_magic())
+    return false ;
+
+  if (r.get_uint() != stamp.size || r.get_uint() != stamp.mtime)
+    return false ; // the .lib changed since the cache was written
+
+  uint64_t numCells = r.get_uint() ;
+  if (!r.fits (numCells))
+    return false ;
+
+  std::unordered_map <string, LibParserCellInfo> cells ;
+  cells.reserve (numCells) ;
+
+  for (uint64_t c=0; r.good() && c < numCells; ++c) {
+
+    LibParserCellInfo cell ;
+    r.get (cell.name) ;
+    r.get (cell.footprint) ;
+    cell.leakagePower = r.get_double() ;
+    cell.area = r.get_double() ;
+    cell.isSequential = r.get_bool() ;
+    cell.dontTouch = r.get_bool() ;
+
+    uint64_t numPins = r.get_uint() ;
+    cell.pins.resize (r.fits (numPins) ? numPins : 0) ;
+    for (uint64_t i=0; r.good() && i < numPins; ++i) {
+      LibParserPinInfo& pin = cell.pins[i] ;
+      r.get (pin.name) ;
+      pin.capacitance = r.get_double() ;
+      pin.maxCapacitance = r.get_double() ;
+      pin.isInput = r.get_bool() ;
+      pin.isClock = r.get_bool() ;
+    }
+
+    uint64_t numArcs = r.get_uint() ;
+    cell.timingArcs.resize (r.fits (numArcs) ? numArcs : 0) ;
+    for (uint64_t i=0; r.good() && i < numArcs; ++i) {
+      LibParserTimingInfo& arc = cell.timingArcs[i] ;
+      r.get (arc.fromPin) ;
+      r.get (arc.toPin) ;
+      r.get (arc.timingSense) ;
+      r.get (arc.timingType) ;
+      r.get (arc.fallDelay) ;
+      r.get (arc.riseDelay) ;
+      r.get (arc.fallTransition) ;
+      r.get (arc.riseTransition) ;
+      r.get (arc.fallConstraint) ;
+      r.get (arc.riseConstraint) ;
+    }
+
+    string name = cell.name ;
+    cells[name] = std::move (cell) ;
+  }
+
+  if (!r.good() || !r.at_end())
+    return false ; // truncated or corrupt, parse the .lib instead
+
+  for (auto it = cells.begin(); it != cells.end(); ++it)
+    Cells[it->first] = std::move (it->second) ;
+
+  return true ;
+}
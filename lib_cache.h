@@ -0,0 +1,33 @@
+/////////////////////////////////////////////////////////////////////
+//
+// Binary cache of the parsed library (the Cells table).
+//
+// The first run parses the .lib as usual and writes <lib>.cache next
+// to it. Later runs check the size and modification time recorded in
+// the cache against the .lib, and if they match they map the cache
+// and rebuild Cells from it instead of parsing the text again.
+//
+/////////////////////////////////////////////////////////////////////
+
+#ifndef _LIB_CACHE_H
+#define _LIB_CACHE_H
+
+#include <string>
+
+using std::string ;
+
+// Set to false (-no_lib_cache) to always parse the .lib
+extern bool UseLibCache ;
+
+// Name of the cache file that belongs to the given library
+string lib_cache_name (string libfile) ;
+
+// Fill Cells from the cache of libfile.
+// Returns false if there is no cache or it is stale or broken.
+bool read_lib_cache (string libfile) ;
+
+// Write the current Cells table as the cache of libfile.
+// Returns false if the cache could not be written.
+bool write_lib_cache (string libfile) ;
+
+#endif
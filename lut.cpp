@@ -0,0 +1,494 @@
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include "parser_helper.h"
+#include "graph.h"
+#include "lut.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_AVX2_KERNEL
+#endif
+
+vector<ArcLUT> ArcLUTs;
+vector< vector<ArcLUT> > CornerLUTs;
+bool UseDelayCache = false;
+double DelayCacheSlewQuantum = 0;
+double DelayCacheLoadQuantum = 0;
+size_t DelayCacheSize = DELAY_CACHE_SIZE;
+
+double BilinearInterpol ( double index1, double index2, const LibParserLUT& lut ) {
+
+  double result = 0;
+  int x1;
+  int x2;
+  int y1;
+  int y2;
+  std::vector<double>::const_iterator low1;
+  std::vector<double>::const_iterator low2;
+
+  /* Binary search for indices */
+  low1 = std::lower_bound (lut.loadIndices.begin(), lut.loadIndices.end(), index1 );
+  low2 = std::lower_bound (lut.transitionIndices.begin(), lut.transitionIndices.end(), index2 );
+  x1 = low1 - lut.loadIndices.begin();
+  y1 = low2 - lut.transitionIndices.begin();
+
+  /* Special cases for index1 */
+  if ( low1 == lut.loadIndices.end() ) {
+    x1 = x1 - 2;
+    x2 = x1 + 1;
+  }
+  else if ( lut.loadIndices[x1] == index1 ) {
+    x2 = x1;
+  }
+  else if ( low1 == lut.loadIndices.begin() ) {
+    x2 = x1 + 1;
+  }
+  else {
+    x2 = x1;
+    x1--;
+  }
+
+  /* Special cases for index2 */
+  if ( low2 == lut.transitionIndices.end() ) {
+    y1 = y1 - 2;
+    y2 = y1 + 1;
+  }
+  else if ( lut.transitionIndices[y1] == index2 ) {
+    y2 = y1;
+  }
+  else if ( low2 == lut.transitionIndices.begin() ) {
+    y2 = y1 + 1;
+  }
+  else {
+    y2 = y1;
+    y1--;
+  }
+
+  if ( x1 == x2 && y1 == y2 ) {
+
+    result = lut.tableVals[y1][x1];
+
+  }
+  else if ( x1 == x2 && y1 != y2 ) {
+
+    result = (lut.tableVals[y2][x1] - lut.tableVals[y1][x1]);
+    result = result/( lut.transitionIndices[y2] - lut.transitionIndices[y1] );
+    result = lut.tableVals[y1][x1] + ( index2 - lut.transitionIndices[y1] )*result;
+
+  } 
+  else if ( x1 != x2 && y1 == y2 ) {
+
+    result = (lut.tableVals[y1][x2] - lut.tableVals[y1][x1]);
+    result = result/( lut.loadIndices[x2] - lut.loadIndices[x1] );
+    result = lut.tableVals[y1][x1] + ( index1 - lut.loadIndices[x1] )*result;
+
+  } 
+  else if ( x1 != x2 && y1 != y2 ) {
+
+    double z_first, z_sec;
+
+    z_first = (lut.tableVals[y1][x2] - lut.tableVals[y1][x1]);
+    z_first = z_first/( lut.loadIndices[x2] - lut.loadIndices[x1] );
+    z_first = lut.tableVals[y1][x1] + ( index1 - lut.loadIndices[x1] )*z_first;
+
+    z_sec = (lut.tableVals[y2][x2] - lut.tableVals[y2][x1]);
+    z_sec = z_sec/( lut.loadIndices[x2] - lut.loadIndices[x1] );
+    z_sec = lut.tableVals[y2][x1] + ( index1 - lut.loadIndices[x1] )*z_sec;
+
+    result = (z_sec - z_first);
+    result = result/( lut.transitionIndices[y2] - lut.transitionIndices[y1] );
+    result = z_first + ( index2 - lut.transitionIndices[y1] )*result;
+
+  } 
+
+  return result;
+
+}
+
+/* The two entries of a table index around a value, the last two past *
+ * its end and the first two before its start, and the weight of hi    */
+static double bracket( const vector<double>& index, double value, int& lo, int& hi ) {
+
+  int n = index.size();
+
+  lo = std::upper_bound( index.begin(), index.end(), value ) - index.begin() - 1;
+  lo = std::max( 0, std::min( lo, n - 2 ) );
+  hi = std::min( lo + 1, n - 1 );
+
+  return ( hi == lo ) ? 0.0 : ( value - index[lo] ) / ( index[hi] - index[lo] );
+
+}
+
+double ConstraintInterpol( double dataSlew, double clockSlew, const LibParserLUT& lut ) {
+
+  if ( lut.loadIndices.empty() || lut.transitionIndices.empty() )
+    return 0;
+
+  int x1, x2, y1, y2;
+  double u = bracket( lut.loadIndices, dataSlew, x1, x2 );
+  double t = bracket( lut.transitionIndices, clockSlew, y1, y2 );
+
+  double first = lut.tableVals[x1][y1] + t * ( lut.tableVals[x1][y2] - lut.tableVals[x1][y1] );
+  double second = lut.tableVals[x2][y1] + t * ( lut.tableVals[x2][y2] - lut.tableVals[x2][y1] );
+
+  return first + u * ( second - first );
+
+}
+
+static const LibParserLUT& arc_table( const LibParserTimingInfo* arc, int table ) {
+
+  switch ( table ) {
+    case LUT_RISE_TRANSITION: return arc->riseTransition;
+    case LUT_FALL_TRANSITION: return arc->fallTransition;
+    case LUT_RISE_DELAY: return arc->riseDelay;
+    default: return arc->fallDelay;
+  }
+
+}
+
+/* Only the sizes the kernels are instantiated for are packed */
+static bool is_packable( const LibParserLUT& lut, int size ) {
+
+  if ( ( size != 7 && size != 8 ) || lut.loadIndices.size() != size ||
+       lut.transitionIndices.size() != size || lut.tableVals.size() != size )
+    return false;
+
+  for ( int i = 0; i < size; i++ )
+    if ( lut.tableVals[i].size() != size )
+      return false;
+
+  return true;
+
+}
+
+void pack_arc_luts( const vector<LibParserTimingInfo*>& arcs, vector<ArcLUT>& luts ) {
+
+  luts.assign( arcs.size(), ArcLUT() );
+
+  for ( ArcId a = 0; a < arcs.size(); a++ ) {
+
+    ArcLUT& packed = luts[a];
+    int size = arc_table( arcs[a], 0 ).loadIndices.size();
+    bool packable = true;
+
+    for ( int t = 0; t < LUT_COUNT; t++ )
+      packable = packable && is_packable( arc_table( arcs[a], t ), size );
+
+    if ( !packable )
+      continue;
+
+    packed.size = size;
+
+    for ( int t = 0; t < LUT_COUNT; t++ ) {
+
+      const LibParserLUT& lut = arc_table( arcs[a], t );
+
+      for ( int k = 0; k < size; k++ ) {
+        packed.load[k][t] = lut.loadIndices[k];
+        packed.transition[k][t] = lut.transitionIndices[k];
+      }
+
+      /* Same [y][x] indexing as BilinearInterpol */
+      for ( int y = 0; y < size; y++ )
+        for ( int x = 0; x < size; x++ )
+          packed.vals[( y * size + x ) * LUT_COUNT + t] = lut.tableVals[y][x];
+    }
+  }
+
+}
+
+void build_arc_luts() {
+
+  pack_arc_luts( ArcTable, ArcLUTs );
+
+}
+
+#ifdef HAVE_AVX2_KERNEL
+
+/* Entries of the index rows around v, one table per lane. Picks the *
+ * same pair as the lower_bound cases of BilinearInterpol: both the  *
+ * same on an exact hit, else the two around v, the first or last    *
+ * two when v is outside the row.                                    */
+template <int N>
+__attribute__((target("avx2")))
+static inline void bracket( const double (*index)[LUT_COUNT], __m256d v, __m256i& i1, __m256i& i2, __m256d& exact ) {
+
+  __m256i below = _mm256_setzero_si256();
+  __m256i upto = _mm256_setzero_si256();
+
+  /* Compares give -1 per lane where they hold */
+  for ( int k = 0; k < N; k++ ) {
+    __m256d row = _mm256_load_pd( index[k] );
+    below = _mm256_sub_epi64( below, _mm256_castpd_si256( _mm256_cmp_pd( row, v, _CMP_LT_OQ ) ) );
+    upto = _mm256_sub_epi64( upto, _mm256_castpd_si256( _mm256_cmp_pd( row, v, _CMP_LE_OQ ) ) );
+  }
+
+  __m256i zero = _mm256_setzero_si256();
+  __m256i one = _mm256_set1_epi64x( 1 );
+  __m256i last = _mm256_set1_epi64x( N - 2 );
+  __m256i hit = _mm256_cmpgt_epi64( upto, below );
+
+  __m256i lo = _mm256_sub_epi64( below, one );
+  lo = _mm256_blendv_epi8( lo, zero, _mm256_cmpgt_epi64( zero, lo ) );
+  lo = _mm256_blendv_epi8( lo, last, _mm256_cmpgt_epi64( lo, last ) );
+
+  i1 = _mm256_blendv_epi8( lo, below, hit );
+  i2 = _mm256_blendv_epi8( _mm256_add_epi64( lo, one ), below, hit );
+  exact = _mm256_castsi256_pd( hit );
+
+}
+
+/* The arithmetic is done in the order of BilinearInterpol, so the  *
+ * results are bit for bit the same. Entries that would divide by 0 *
+ * on an exact hit are computed anyway and blended out.             */
+template <int N>
+__attribute__((target("avx2")))
+static void interpolate_avx2( const ArcLUT& lut, double load, const double* slew, double* out ) {
+
+  const __m256i lane = _mm256_set_epi64x( 3, 2, 1, 0 );
+  const __m256i size = _mm256_set1_epi64x( N );
+
+  __m256i x1, x2;
+  __m256d exactX;
+  __m256d vload = _mm256_set1_pd( load );
+
+  bracket<N>( lut.load, vload, x1, x2, exactX );
+
+  __m256d l1 = _mm256_i64gather_pd( &lut.load[0][0], _mm256_add_epi64( _mm256_slli_epi64( x1, 2 ), lane ), 8 );
+  __m256d l2 = _mm256_i64gather_pd( &lut.load[0][0], _mm256_add_epi64( _mm256_slli_epi64( x2, 2 ), lane ), 8 );
+  __m256d dl = _mm256_sub_pd( vload, l1 );
+  __m256d wl = _mm256_sub_pd( l2, l1 );
+
+  /* Early slews, then late */
+  for ( int h = 0; h < 2; h++ ) {
+
+    __m256i y1, y2;
+    __m256d exactY;
+    __m256d vslew = _mm256_loadu_pd( slew + 4 * h );
+
+    bracket<N>( lut.transition, vslew, y1, y2, exactY );
+
+    __m256d t1 = _mm256_i64gather_pd( &lut.transition[0][0], _mm256_add_epi64( _mm256_slli_epi64( y1, 2 ), lane ), 8 );
+    __m256d t2 = _mm256_i64gather_pd( &lut.transition[0][0], _mm256_add_epi64( _mm256_slli_epi64( y2, 2 ), lane ), 8 );
+
+    __m256i row1 = _mm256_mul_epu32( y1, size );
+    __m256i row2 = _mm256_mul_epu32( y2, size );
+
+    __m256d v11 = _mm256_i64gather_pd( lut.vals, _mm256_add_epi64( _mm256_slli_epi64( _mm256_add_epi64( row1, x1 ), 2 ), lane ), 8 );
+    __m256d v12 = _mm256_i64gather_pd( lut.vals, _mm256_add_epi64( _mm256_slli_epi64( _mm256_add_epi64( row1, x2 ), 2 ), lane ), 8 );
+    __m256d v21 = _mm256_i64gather_pd( lut.vals, _mm256_add_epi64( _mm256_slli_epi64( _mm256_add_epi64( row2, x1 ), 2 ), lane ), 8 );
+    __m256d v22 = _mm256_i64gather_pd( lut.vals, _mm256_add_epi64( _mm256_slli_epi64( _mm256_add_epi64( row2, x2 ), 2 ), lane ), 8 );
+
+    __m256d zFirst = _mm256_add_pd( v11, _mm256_mul_pd( dl, _mm256_div_pd( _mm256_sub_pd( v12, v11 ), wl ) ) );
+    __m256d zSec = _mm256_add_pd( v21, _mm256_mul_pd( dl, _mm256_div_pd( _mm256_sub_pd( v22, v21 ), wl ) ) );
+    zFirst = _mm256_blendv_pd( zFirst, v11, exactX );
+    zSec = _mm256_blendv_pd( zSec, v21, exactX );
+
+    __m256d result = _mm256_div_pd( _mm256_sub_pd( zSec, zFirst ), _mm256_sub_pd( t2, t1 ) );
+    result = _mm256_add_pd( zFirst, _mm256_mul_pd( _mm256_sub_pd( vslew, t1 ), result ) );
+    result = _mm256_blendv_pd( result, zFirst, exactY );
+
+    _mm256_storeu_pd( out + 4 * h, result );
+  }
+
+}
+
+static bool has_avx2() {
+
+  static const bool avx2 = __builtin_cpu_supports( "avx2" );
+  return avx2;
+
+}
+
+#endif
+
+static void interpolate_tables( const ArcLUT& lut, const LibParserTimingInfo& arc, double load, const double* slew, double* out ) {
+
+#ifdef HAVE_AVX2_KERNEL
+
+  if ( lut.size == 7 && has_avx2() ) {
+    interpolate_avx2<7>( lut, load, slew, out );
+    return;
+  }
+
+  if ( lut.size == 8 && has_avx2() ) {
+    interpolate_avx2<8>( lut, load, slew, out );
+    return;
+  }
+
+#endif
+
+  for ( int i = 0; i < 2 * LUT_COUNT; i++ )
+    out[i] = BilinearInterpol( load, slew[i], arc_table( &arc, i % LUT_COUNT ) );
+
+}
+
+/* One half of an evaluation, early or late: the four tables at one *
+ * load, the rise tables at one slew and the fall tables at another. */
+struct DelayCacheEntry {
+
+  const LibParserTimingInfo* arc;   // nullptr while the slot is empty
+  int64_t load;
+  int64_t slewRise;
+  int64_t slewFall;
+  double out[LUT_COUNT];
+
+};
+
+struct DelayCache {
+
+  vector<DelayCacheEntry> entries;
+  double slewQuantum;
+  double loadQuantum;
+  uint64_t hits;
+  uint64_t misses;
+
+  DelayCache () : slewQuantum (0.0), loadQuantum (0.0), hits (0), misses (0) {}
+
+};
+
+/* The caches of all threads, for the counters. A thread makes its own *
+ * the first time it looks something up and keeps it.                 */
+static std::mutex CacheLock;
+static vector< std::unique_ptr<DelayCache> > Caches;
+static thread_local DelayCache* ThreadCache = nullptr;
+
+static DelayCache& thread_cache() {
+
+  if ( ThreadCache == nullptr ) {
+    std::lock_guard<std::mutex> guard( CacheLock );
+    Caches.emplace_back( new DelayCache() );
+    ThreadCache = Caches.back().get();
+  }
+
+  /* The settings changed since the entries were made */
+  DelayCache& cache = *ThreadCache;
+  size_t size = size_t( 1 ) << ( 63 - __builtin_clzll( std::max<size_t>( DelayCacheSize, 1 ) ) );
+
+  if ( cache.entries.size() != size || cache.slewQuantum != DelayCacheSlewQuantum ||
+       cache.loadQuantum != DelayCacheLoadQuantum ) {
+    DelayCacheEntry empty = DelayCacheEntry();
+    cache.entries.assign( size, empty );
+    cache.slewQuantum = DelayCacheSlewQuantum;
+    cache.loadQuantum = DelayCacheLoadQuantum;
+  }
+
+  return cache;
+
+}
+
+/* Key of a value and the value the tables are evaluated at. False if *
+ * it is too far out to round.                                        */
+static inline bool round_key( double x, double quantum, int64_t& key, double& at ) {
+
+  if ( quantum <= 0 ) {
+    std::memcpy( &key, &x, sizeof(x) );
+    at = x;
+    return true;
+  }
+
+  double q = std::nearbyint( x / quantum );
+  if ( !( std::fabs( q ) < 4e18 ) )
+    return false;
+
+  key = (int64_t) q;
+  at = q * quantum;
+  return true;
+
+}
+
+static inline size_t slot_of( const DelayCacheEntry& key, size_t size ) {
+
+  uint64_t h = (uint64_t) (uintptr_t) key.arc * 0x9e3779b97f4a7c15ull;
+  h = ( h ^ (uint64_t) key.load ) * 0xbf58476d1ce4e5b9ull;
+  h = ( h ^ (uint64_t) key.slewRise ) * 0x94d049bb133111ebull;
+  h = ( h ^ (uint64_t) key.slewFall ) * 0x9e3779b97f4a7c15ull;
+
+  return ( h >> 32 ) & ( size - 1 );
+
+}
+
+static inline bool same_key( const DelayCacheEntry& a, const DelayCacheEntry& b ) {
+  return a.arc == b.arc && a.load == b.load && a.slewRise == b.slewRise && a.slewFall == b.slewFall;
+}
+
+void interpolate_lut( const ArcLUT& lut, const LibParserTimingInfo& arc, double load, const double* slew, double* out ) {
+
+  if ( !UseDelayCache ) {
+    interpolate_tables( lut, arc, load, slew, out );
+    return;
+  }
+
+  DelayCache& cache = thread_cache();
+  DelayCacheEntry key[2];
+  double at[2 * LUT_COUNT];
+  double atLoad;
+  bool keyed = round_key( load, cache.loadQuantum, key[0].load, atLoad );
+
+  /* Early half, then late. The delay table of an output edge must see *
+   * the same slew as its transition table for one key to cover both. */
+  for ( int h = 0; h < 2 && keyed; h++ ) {
+
+    const double* s = slew + h * LUT_COUNT;
+
+    keyed = s[LUT_RISE_DELAY] == s[LUT_RISE_TRANSITION] && s[LUT_FALL_DELAY] == s[LUT_FALL_TRANSITION] &&
+            round_key( s[LUT_RISE_TRANSITION], cache.slewQuantum, key[h].slewRise, at[h * LUT_COUNT + LUT_RISE_TRANSITION] ) &&
+            round_key( s[LUT_FALL_TRANSITION], cache.slewQuantum, key[h].slewFall, at[h * LUT_COUNT + LUT_FALL_TRANSITION] );
+
+    at[h * LUT_COUNT + LUT_RISE_DELAY] = at[h * LUT_COUNT + LUT_RISE_TRANSITION];
+    at[h * LUT_COUNT + LUT_FALL_DELAY] = at[h * LUT_COUNT + LUT_FALL_TRANSITION];
+    key[h].arc = &arc;
+    key[h].load = key[0].load;
+  }
+
+  if ( !keyed ) {
+    interpolate_tables( lut, arc, load, slew, out );
+    return;
+  }
+
+  size_t size = cache.entries.size();
+  DelayCacheEntry* entry[2] = { &cache.entries[slot_of( key[0], size )], &cache.entries[slot_of( key[1], size )] };
+  bool found[2] = { same_key( *entry[0], key[0] ), same_key( *entry[1], key[1] ) };
+
+  if ( found[0] && found[1] ) {
+    std::memcpy( out, entry[0]->out, sizeof(entry[0]->out) );
+    std::memcpy( out + LUT_COUNT, entry[1]->out, sizeof(entry[1]->out) );
+    cache.hits += 2;
+    return;
+  }
+
+  /* Both halves come out of one evaluation anyway */
+  interpolate_tables( lut, arc, atLoad, at, out );
+
+  for ( int h = 0; h < 2; h++ ) {
+    *entry[h] = key[h];
+    std::memcpy( entry[h]->out, out + h * LUT_COUNT, sizeof(entry[h]->out) );
+    if ( found[h] )
+      cache.hits++;
+    else
+      cache.misses++;
+  }
+
+}
+
+void delay_cache_stats( uint64_t& hits, uint64_t& misses ) {
+
+  std::lock_guard<std::mutex> guard( CacheLock );
+
+  hits = misses = 0;
+  for ( auto it = Caches.begin(); it != Caches.end(); it++ ) {
+    hits += (*it)->hits;
+    misses += (*it)->misses;
+  }
+
+}
+
+void interpolate_arc( ArcId arc, double load, const double* slew, double* out ) {
+
+  interpolate_lut( ArcLUTs[arc], *ArcTable[arc], load, slew, out );
+
+}
@@ -0,0 +1,76 @@
+#ifndef _LUT_H
+#define _LUT_H
+
+#include "graph.h"
+
+/* Largest table kept in packed form */
+#define LUT_MAX_SIZE 8
+
+/* Tables of a timing arc, in the order interpolate_arc evaluates them */
+enum { LUT_RISE_TRANSITION, LUT_FALL_TRANSITION, LUT_RISE_DELAY, LUT_FALL_DELAY, LUT_COUNT };
+
+/* The four tables of an arc in one contiguous block, interleaved so *
+ * that entry k of all four tables is one 32 byte row: load[k][t] is *
+ * load index k of table t and vals[(y*size + x)*4 + t] its value at *
+ * transition index y, load index x. Only arcs whose tables are all  *
+ * 7x7 or all 8x8 are packed; size is 0 for the others, which go     *
+ * through BilinearInterpol.                                         */
+struct alignas(32) ArcLUT {
+
+  double load[LUT_MAX_SIZE][LUT_COUNT];
+  double transition[LUT_MAX_SIZE][LUT_COUNT];
+  double vals[LUT_MAX_SIZE * LUT_MAX_SIZE * LUT_COUNT];
+  int size;
+
+  ArcLUT () : size (0) {}
+
+};
+
+extern vector<ArcLUT> ArcLUTs;   // by ArcId
+extern vector< vector<ArcLUT> > CornerLUTs;   // by extra corner, then ArcId
+
+/* Interpolate a table at (load, transition) */
+double BilinearInterpol( double index1, double index2, const LibParserLUT& lut );
+
+/* Interpolate a setup or hold table at (data transition, clock        *
+ * transition). Its rows follow index_1, as the library writes them.   *
+ * Extrapolates past the ends; 0 when the arc has no such table.       */
+double ConstraintInterpol( double dataSlew, double clockSlew, const LibParserLUT& lut );
+
+/* Pack the tables of arcs[a] to luts[a] */
+void pack_arc_luts( const vector<LibParserTimingInfo*>& arcs, vector<ArcLUT>& luts );
+
+/* Pack the tables of every arc in ArcTable */
+void build_arc_luts();
+
+/* Evaluate all four tables of an arc at one load. slew[0..3] are the    *
+ * input transitions of the early evaluations and slew[4..7] of the late *
+ * ones; out[i] is table i % 4 at slew[i]. The results are the same as   *
+ * eight calls of BilinearInterpol; packed 7x7 and 8x8 arcs use an AVX2  *
+ * kernel when the cpu has it.                                           */
+void interpolate_arc( ArcId arc, double load, const double* slew, double* out );
+
+/* Same for the packed tables of an arc of any corner */
+void interpolate_lut( const ArcLUT& lut, const LibParserTimingInfo& arc, double load, const double* slew, double* out );
+
+/* Memo cache of the arc evaluations, keyed by arc, load and the input  *
+ * slews of the rise and fall tables. Off unless UseDelayCache is set.  *
+ * Slews are rounded to multiples of DelayCacheSlewQuantum, in the time *
+ * unit of the library, and loads to multiples of DelayCacheLoadQuantum *
+ * in its capacitance unit (ps and fF in the TAU libraries). The tables *
+ * are evaluated at the rounded point, so a result is the table value   *
+ * up to half a quantum away from the inputs, and an entry only depends *
+ * on its key, whichever thread made it. Quanta of 0 key on the exact   *
+ * values and change no result. Every thread has a table of             *
+ * DelayCacheSize entries, a new entry replaces the one in its slot.    */
+#define DELAY_CACHE_SIZE (1 << 16)
+
+extern bool UseDelayCache;
+extern double DelayCacheSlewQuantum;
+extern double DelayCacheLoadQuantum;
+extern size_t DelayCacheSize;
+
+/* Lookups that found their entry and lookups that did not, all threads */
+void delay_cache_stats( uint64_t& hits, uint64_t& misses );
+
+#endif
@@ -0,0 +1,242 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <limits>
+#include "parser_helper.h"
+#include "graph.h"
+#include "paths.h"
+#include "ops.h"
+
+/* Pins are named instance:pin in the ops file and instance + pin in PinNames */
+static PinId find_pin( string_view token ) {
+
+  string name( token );
+
+  size_t colon = name.find( ':' );
+  if ( colon != string::npos )
+    name.erase( colon, 1 );
+
+  return PinNames.find( name );
+
+}
+
+/* The tokenizer splits off ':', '/' and '#', which pin names, paths and *
+ * comments have. Tokens that touch in the file are one word of the op.  */
+static void join_words( const vector<string_view>& tokens, vector<string_view>& words ) {
+
+  words.clear();
+
+  for ( auto it = tokens.begin(); it != tokens.end(); it++ ) {
+    if ( !words.empty() && words.back().data() + words.back().size() == it->data() )
+      words.back() = string_view( words.back().data(), words.back().size() + it->size() );
+    else
+      words.push_back( *it );
+  }
+
+}
+
+/* Options of a query. Without -early or -late a query is late, *
+ * without -rise or -fall it is rise.                           */
+struct OpsQuery {
+
+  PinId pin;
+  bool late;
+  bool rise;
+  unsigned int numPaths;
+
+  OpsQuery () : pin (INVALID_ID), late (true), rise (true), numPaths (1) {}
+
+};
+
+/* Pins without an arrival or a required time have them at +-max */
+static void print_value( std::ostream& out, double value ) {
+
+  if ( std::fabs( value ) == std::numeric_limits<double>::max() )
+    out << "NA\n";
+  else
+    out << value << "\n";
+
+}
+
+static bool parse_query( const vector<string_view>& tokens, OpsQuery& query ) {
+
+  for ( unsigned int i = 1; i < tokens.size(); i++ ) {
+
+    if ( tokens[i] == "-pin" && i + 1 < tokens.size() ) {
+      query.pin = find_pin( tokens[++i] );
+      if ( query.pin == INVALID_ID ) {
+        cout << "Error: Unknown pin " << tokens[i] << endl;
+        return false;
+      }
+    }
+    else if ( tokens[i] == "-numPaths" && i + 1 < tokens.size() )
+      query.numPaths = std::max( 0, atoi( string( tokens[++i] ).c_str() ) );
+    else if ( tokens[i] == "-early" || tokens[i] == "-late" )
+      query.late = ( tokens[i] == "-late" );
+    else if ( tokens[i] == "-rise" || tokens[i] == "-fall" )
+      query.rise = ( tokens[i] == "-rise" );
+  }
+
+  return true;
+
+}
+
+/* Parasitics of the nets in a spef file replace the ones they had */
+static void read_spef( const string& filename ) {
+
+  vector<string> names;
+  read_spef_parallel( filename, &names );
+
+  for ( auto it = names.begin(); it != names.end(); it++ ) {
+    NetId net = NetNames.find( *it );
+    if ( net == INVALID_ID )
+      continue;
+    NetTable[net].spef = &SpefNets[*it];
+    invalidate_net( net );
+  }
+
+}
+
+/* Netlist edits. Returns 0 if the op is short a word or the edit *
+ * cannot be made.                                                 */
+static int edit_netlist( const vector<string_view>& tokens ) {
+
+  string_view op = tokens[0];
+
+  if ( op == "insert_gate" && tokens.size() > 2 )
+    return insert_gate( string( tokens[1] ), string( tokens[2] ) );
+  if ( op == "remove_gate" && tokens.size() > 1 )
+    return remove_gate( string( tokens[1] ) );
+  if ( op == "insert_net" && tokens.size() > 1 )
+    return insert_net( string( tokens[1] ) );
+  if ( op == "remove_net" && tokens.size() > 1 )
+    return remove_net( string( tokens[1] ) );
+  if ( op == "connect_pin" && tokens.size() > 2 )
+    return connect_pin( find_pin( tokens[1] ), string( tokens[2] ) );
+  if ( op == "disconnect_pin" && tokens.size() > 1 )
+    return disconnect_pin( find_pin( tokens[1] ) );
+
+  return 0;
+
+}
+
+int run_ops( const string& opsFile, const string& outFile ) {
+
+  MappedFile file( opsFile );
+  if ( !file.is_open() )
+    return 0;
+
+  TokenStream is( file.begin(), file.end() );
+
+  std::ofstream outfile;
+  if ( !outFile.empty() )
+    outfile.open( outFile );
+  std::ostream& out = outFile.empty() ? cout : outfile;
+
+  /* Files the ops refer to are next to the ops file */
+  size_t index = opsFile.find_last_of( "/" );
+  string base_path = ( index == string::npos ) ? "" : opsFile.substr( 0, index + 1 );
+
+  unsigned int numEdits = 0, numUpdates = 0;
+  bool pending = false, skipped = false;
+  vector<string_view> line, tokens;
+
+  while ( is.read_line_as_tokens( line, true ) ) {
+
+    join_words( line, tokens );
+
+    if ( tokens[0][0] == '#' )
+      continue;
+
+    string_view op = tokens[0];
+
+    /* Edits. They only mark the pins and nets they change */
+    if ( op == "read_spef" && tokens.size() > 1 ) {
+      read_spef( tokens[1][0] == '/' ? string( tokens[1] ) : base_path + string( tokens[1] ) );
+      pending = true;
+      numEdits++;
+      continue;
+    }
+
+    if ( op == "repower_gate" && tokens.size() > 2 ) {
+      if ( repower_gate( string( tokens[1] ), string( tokens[2] ) ) ) {
+        pending = true;
+        numEdits++;
+      }
+      else
+        cout << "Error: Cannot repower " << tokens[1] << " to " << tokens[2] << endl;
+      continue;
+    }
+
+    /* The netlist is rebuilt once, by the next update_timing. After an *
+     * edit that could not be made it is not the one the ops describe,  *
+     * so nothing is answered from then on.                             */
+    if ( op == "insert_gate" || op == "remove_gate" || op == "insert_net" ||
+         op == "remove_net" || op == "connect_pin" || op == "disconnect_pin" ) {
+      if ( edit_netlist( tokens ) ) {
+        pending = true;
+        numEdits++;
+      }
+      else {
+        cout << "Error: Cannot";
+        for ( auto it = tokens.begin(); it != tokens.end(); it++ )
+          cout << " " << *it;
+        cout << endl;
+        skipped = true;
+      }
+      continue;
+    }
+
+    OpsQuery query;
+
+    /* Every query gets its line in the output, answered or not */
+    if ( op != "report_at" && op != "report_slew" && op != "report_rat" &&
+         op != "report_slack" && op != "report_worst_paths" ) {
+      cout << "Warning: Unknown op " << op << endl;
+      if ( op.compare( 0, 7, "report_" ) == 0 )
+        out << "NA\n";
+      continue;
+    }
+
+    /* Queries. The edits since the last one are re-timed together */
+    if ( pending ) {
+      update_timing();
+      pending = false;
+      numUpdates++;
+    }
+
+    /* After a rebuild the pins have new ids, so they are looked up here */
+    if ( skipped || !parse_query( tokens, query ) ) {
+      out << "NA\n";
+      continue;
+    }
+
+    if ( op == "report_worst_paths" ) {
+      print_paths( report_worst_paths( query.numPaths, query.late, query.pin ), query.late, out );
+      continue;
+    }
+
+    if ( query.pin == INVALID_ID ) {
+      cout << "Error: " << op << " needs a -pin" << endl;
+      out << "NA\n";
+      continue;
+    }
+
+    if ( op == "report_at" )
+      print_value( out, report_at( query.pin, query.rise, query.late ) );
+    else if ( op == "report_slew" )
+      print_value( out, report_slew( query.pin, query.rise, query.late ) );
+    else if ( op == "report_rat" )
+      print_value( out, report_rat( query.pin, query.rise, query.late ) );
+    else
+      print_value( out, report_slack( query.pin, query.rise, query.late ) );
+  }
+
+  out.flush();
+  cout << "Ran " << numEdits << " edits in " << numUpdates << " timing updates." << endl;
+
+  return 1;
+
+}
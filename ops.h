@@ -0,0 +1,16 @@
+#ifndef _OPS_H
+#define _OPS_H
+
+#include "graph.h"
+
+/* Run the edits and queries of an .ops file on the timed design, in   *
+ * order, and write the answers of the queries to outFile (stdout if   *
+ * it is empty), one per line. Edits only mark what they change; the   *
+ * first query after a run of edits re-times all of them with a single *
+ * update_timing. In the lazy mode that is left to the queries, which  *
+ * only time what they read. Netlist edits have that update rebuild    *
+ * the graph. After a netlist edit that cannot be made every query     *
+ * answers NA. Returns 0 if the ops file cannot be read or is empty.   */
+int run_ops( const string& opsFile, const string& outFile );
+
+#endif
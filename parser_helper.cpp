@@ -23,7 +23,15 @@
 #include <cassert>
 #include <cctype>
 #include <algorithm>
+#include <charconv>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "parser_helper.h"
+#include "thread_pool.h"
+#include "lib_cache.h"
+#include "rc_tree.h"
 
 /* Global variable that stores Cells */
 std::unordered_map <string, LibParserCellInfo> Cells ;
@@ -31,62 +39,107 @@ std::unordered_map <string, VerParserPinInfo> Pins ;
 std::unordered_map <string, NetParserInfo> NetsHelper ;
 std::unordered_map <string, SpefNet> SpefNets;
 
-bool is_special_char (char c) {
+bool SpefStreaming = false ;
 
-  static const char specialChars[] = {'(', ')', ',', ':', ';', '/', '#', '[', ']', '{', '}', '*', '\"', '\\'} ;
-  
-  for (int i=0; i < sizeof(specialChars); ++i) {
-    if (c == specialChars[i])
-      return true ;
+string ClockPort ;
+double ClockPeriod = 0.0 ;
+
+MappedFile::MappedFile (string filename) : data (nullptr), size (0) {
+
+  int fd = open (filename.c_str(), O_RDONLY) ;
+  if (fd < 0)
+    return ;
+
+  struct stat st ;
+  if (fstat (fd, &st) == 0 && st.st_size > 0) {
+
+    void* addr = mmap (nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0) ;
+    if (addr != MAP_FAILED) {
+      madvise (addr, st.st_size, MADV_SEQUENTIAL) ;
+      data = static_cast<const char*> (addr) ;
+      size = st.st_size ;
+    }
   }
 
-  return false ;
+  // The mapping stays valid after the descriptor is closed
+  close (fd) ;
+}
+
+MappedFile::~MappedFile () {
+
+  if (data != nullptr)
+    munmap (const_cast<char*> (data), size) ;
+}
+
+
+// Character classes used by the tokenizer, one entry per byte value
+enum { CHAR_PLAIN = 0, CHAR_SPACE = 1, CHAR_SPECIAL = 2, CHAR_NEWLINE = 4 } ;
+
+struct CharClassTable {
+
+  unsigned char cls[256] ;
+
+  constexpr CharClassTable () : cls () {
+
+    const char spaces[] = " \t\v\f\r" ;
+    const char specialChars[] = "(),:;/#[]{}*\"\\" ;
+
+    for (int i=0; spaces[i] != '\0'; ++i)
+      cls[(unsigned char) spaces[i]] = CHAR_SPACE ;
+    for (int i=0; specialChars[i] != '\0'; ++i)
+      cls[(unsigned char) specialChars[i]] = CHAR_SPECIAL ;
+
+    cls[(unsigned char) '\n'] = CHAR_SPACE | CHAR_NEWLINE ;
+  }
+
+} ;
+
+static constexpr CharClassTable CharClasses ;
+
+bool is_special_char (char c) {
+
+  return CharClasses.cls[(unsigned char) c] & CHAR_SPECIAL ;
 }
 
 // Read the next line and return it as a list of tokens skipping white space and special characters
 // The return value indicates success/failure.
-bool read_line_as_tokens (istream& is, vector<string>& tokens,
-			  bool includeSpecialChars = false) {
+bool TokenStream::read_line_as_tokens (vector<string_view>& tokens, bool includeSpecialChars) {
 
   tokens.clear() ;
-  
-  string line ;
-  std::getline (is, line) ;
 
-  while (is && tokens.empty()) {
-    
-    string token = "" ;
-
-    for (int i=0; i < line.size(); ++i) {
-      char currChar = line[i] ;
-      bool isSpecialChar = is_special_char(currChar) ;
+  while (curr < last && tokens.empty()) {
 
-      if (std::isspace (currChar) || isSpecialChar) {
+    const char* tokenBegin = nullptr ;
 
-        if (!token.empty()) {
-          // Add the current token to the list of tokens
-          tokens.push_back(token) ;
-          token.clear() ;
-        }
+    for ( ; curr < last; ++curr) {
+      unsigned char currClass = CharClasses.cls[(unsigned char) *curr] ;
 
-	if (includeSpecialChars && isSpecialChar) {
-	  tokens.push_back(string(1, currChar)) ;
-	}
-
-      } else {
+      if (currClass == CHAR_PLAIN) {
         // Add the char to the current token
-        token.push_back(currChar) ;
+        if (tokenBegin == nullptr)
+          tokenBegin = curr ;
+        continue ;
+      }
+
+      if (tokenBegin != nullptr) {
+        // Add the current token to the list of tokens
+        tokens.emplace_back(tokenBegin, curr - tokenBegin) ;
+        tokenBegin = nullptr ;
       }
 
+      if (includeSpecialChars && (currClass & CHAR_SPECIAL))
+        tokens.emplace_back(curr, 1) ;
+
+      if (currClass & CHAR_NEWLINE) {
+        ++curr ;
+        break ;
+      }
     }
 
-    if (!token.empty())
-      tokens.push_back(token) ;
-    
+    if (tokenBegin != nullptr)
+      tokens.emplace_back(tokenBegin, curr - tokenBegin) ;
 
-    if (tokens.empty())
-      // Previous line read was empty. Read the next one.
-      std::getline (is, line) ;    
+    // If the line was empty, the loop reads the next one.
   }
 
   //for (int i=0; i < tokens.size(); ++i)
@@ -96,11 +149,29 @@ bool read_line_as_tokens (istream& is, vector<string>& tokens,
   return !tokens.empty() ;
 }
 
+bool read_line_as_tokens (TokenStream& is, vector<string_view>& tokens,
+			  bool includeSpecialChars = false) {
+
+  return is.read_line_as_tokens (tokens, includeSpecialChars) ;
+}
+
+double token_to_double (string_view token) {
+
+  double value = 0.0 ;
+
+  // std::atof accepts a leading '+', std::from_chars does not
+  if (!token.empty() && token[0] == '+')
+    token.remove_prefix(1) ;
+
+  std::from_chars (token.data(), token.data() + token.size(), value) ;
+  return value ;
+}
+
 
 
 bool VerilogParser::read_module (string& moduleName) {
 
-  vector<string> tokens ;
+  vector<string_view> tokens ;
   bool valid = read_line_as_tokens (is, tokens) ;
 
   while (valid) {
@@ -129,7 +200,7 @@ bool VerilogParser::read_primary_input (string& primaryInput) {
 
   primaryInput = "" ;
   
-  vector<string> tokens ;
+  vector<string_view> tokens ;
   bool valid = read_line_as_tokens (is, tokens) ;
 
   assert (valid) ;
@@ -152,7 +223,7 @@ bool VerilogParser::read_primary_output (string& primaryOutput) {
 
   primaryOutput = "" ;
   
-  vector<string> tokens ;
+  vector<string_view> tokens ;
   bool valid = read_line_as_tokens (is, tokens) ;
 
   assert (valid) ;
@@ -174,7 +245,7 @@ bool VerilogParser::read_wire (string& wire) {
 
   wire = "" ;
   
-  vector<string> tokens ;
+  vector<string_view> tokens ;
   bool valid = read_line_as_tokens (is, tokens) ;
 
   assert (valid) ;
@@ -198,7 +269,7 @@ bool VerilogParser::read_cell_inst (string& cellType, string& cellInstName) {
   cellInstName = "" ;
   //pinNetPairs.clear() ;
 
-  vector<string> tokens ;
+  vector<string_view> tokens ;
   bool valid = read_line_as_tokens (is, tokens) ;
   VerParserPinInfo pinInfo;
 
@@ -217,7 +288,7 @@ bool VerilogParser::read_cell_inst (string& cellType, string& cellInstName) {
 
   /* Some temporary variables */
   NetPin newPin;
-  std::vector<LibParserPinInfo>::iterator cell_fromPin, cell_toPin;
+  const LibParserCellInfo& cell = Cells[cellType];
 
 
   /* Store in-cell connections. Iterate through all timing arcs *
@@ -225,26 +296,25 @@ bool VerilogParser::read_cell_inst (string& cellType, string& cellInstName) {
    * the Nets hash table.                                       *
    * Reminder: They are the opposite of the normal nets.        *
    * Inputs are outputs and the opposite                        */
-  int number_of_arcs = Cells[cellType].timingArcs.size();
+  int number_of_arcs = cell.timingArcs.size();
 
   for ( int j = 0; j < number_of_arcs; j++ ) {
 
-    string fromPin = Cells[cellType].timingArcs[j].fromPin;
-    string toPin = Cells[cellType].timingArcs[j].toPin;
+    const string& fromPin = cell.timingArcs[j].fromPin;
+    const string& toPin = cell.timingArcs[j].toPin;
 
     newPin.instance_name = cellInstName; 
-    newPin.pinName = Cells[cellType].timingArcs[j].fromPin;
+    newPin.pinName = fromPin;
     newPin.cellType = cellType;
     string key = cellInstName + fromPin;
 
     NetsHelper[key].output = newPin;
+    NetsHelper[key].isCellArc = true;
 
     /* Find the pins in order to check if they are clocks or inputs. *
      * In case we find a FF don't connect ck with d                  */
-    cell_fromPin = std::find_if( Cells[cellType].pins.begin(), Cells[cellType].pins.end(),
-                                  findPinInfo( fromPin ) ); 
-    cell_toPin = std::find_if( Cells[cellType].pins.begin(), Cells[cellType].pins.end(),
-                                findPinInfo( toPin ) ); 
+    const LibParserPinInfo* cell_fromPin = cell.find_pin( fromPin );
+    const LibParserPinInfo* cell_toPin = cell.find_pin( toPin );
  
     if ( (cell_fromPin->isInput || cell_fromPin->isClock) && !cell_toPin->isInput ) {
       newPin.pinName = toPin;
@@ -257,9 +327,8 @@ bool VerilogParser::read_cell_inst (string& cellType, string& cellInstName) {
   for (int i=2; i < tokens.size()-1; i += 2) {
 
     assert (tokens[i][0] == '.') ; // pin names start with '.'
-    string pinName = tokens[i].substr(1) ; // skip the first character of tokens[i] 
-    std::vector<LibParserPinInfo>::iterator cellPin  = std::find_if( Cells[cellType].pins.begin(), Cells[cellType].pins.end(),
-                                                                     findPinInfo( pinName ) ); // Find out if I am input or output
+    string pinName (tokens[i].substr(1)) ; // skip the first character of tokens[i] 
+    const LibParserPinInfo* cellPin = cell.find_pin( pinName ); // Find out if I am input or output
     pinInfo.isInput = cellPin->isInput ;    
 
     /* Create a newPin and store info */
@@ -269,13 +338,14 @@ bool VerilogParser::read_cell_inst (string& cellType, string& cellInstName) {
   
     /* Create key for Pins hash table */
     string key = cellInstName + pinName;
-    NetsHelper[tokens[i+1]].name = pinName ; // Copy net name
+    NetParserInfo& net = NetsHelper[string(tokens[i+1])] ;
+    net.name = pinName ; // Copy net name
 
     // Store net inputs and outputs
     if ( pinInfo.isInput )
-      NetsHelper[tokens[i+1]].inputs.push_back(newPin) ;
+      net.inputs.push_back(newPin) ;
     else
-      NetsHelper[tokens[i+1]].output = newPin ;
+      net.output = newPin ;
     
     // Store net info inside the Net hash table and 
     // also store the pin to Pin hash table
@@ -283,8 +353,8 @@ bool VerilogParser::read_cell_inst (string& cellType, string& cellInstName) {
     Pins[key].connNetName = tokens[i+1];
     Pins[key].tr_r_early = std::numeric_limits<double>::max();
     Pins[key].tr_f_early = std::numeric_limits<double>::max();
-    Pins[key].tr_r_late = std::numeric_limits<double>::min();
-    Pins[key].tr_f_late = std::numeric_limits<double>::min();
+    Pins[key].tr_r_late = std::numeric_limits<double>::lowest();
+    Pins[key].tr_f_late = std::numeric_limits<double>::lowest();
   }
 
   return valid ;
@@ -299,7 +369,7 @@ bool SdcParser::read_clock (string& clockName, string& clockPort, double& period
   clockPort = "" ;
   period = 0.0 ;
   
-  vector<string> tokens ;
+  vector<string_view> tokens ;
   bool valid = read_line_as_tokens (is, tokens) ;
 
   while (valid) {
@@ -309,7 +379,7 @@ bool SdcParser::read_clock (string& clockName, string& clockPort, double& period
       clockName = tokens[2] ;
   
       assert (tokens[3] == "-period") ;
-      period = std::atof(tokens[4].c_str()) ;
+      period = token_to_double(tokens[4]) ;
       
       assert (tokens[5] == "get_ports") ;
       clockPort = tokens[6] ;
@@ -335,7 +405,7 @@ bool SdcParser::read_input_delay (string& portName, double& delay) {
   portName = "" ;
   delay = 0.0 ;
 
-  vector<string> tokens ;
+  vector<string_view> tokens ;
   bool valid = read_line_as_tokens (is, tokens) ;
 
   assert (valid) ;
@@ -344,7 +414,7 @@ bool SdcParser::read_input_delay (string& portName, double& delay) {
   if (valid && tokens[0] == "set_input_delay") {
     assert (tokens.size() == 6) ;
 
-    delay = std::atof(tokens[1].c_str()) ;
+    delay = token_to_double(tokens[1]) ;
 
     assert (tokens[2] == "get_ports") ;
 
@@ -372,7 +442,7 @@ bool SdcParser::read_output_delay (string& portName, double& delay) {
   portName = "" ;
   delay = 0.0 ;
 
-  vector<string> tokens ;
+  vector<string_view> tokens ;
   bool valid = read_line_as_tokens (is, tokens) ;
 
   assert (valid) ;
@@ -381,7 +451,7 @@ bool SdcParser::read_output_delay (string& portName, double& delay) {
   if (valid && tokens[0] == "set_output_delay") {
     assert (tokens.size() == 6) ;
 
-    delay = std::atof(tokens[1].c_str()) ;
+    delay = token_to_double(tokens[1]) ;
 
     assert (tokens[2] == "get_ports") ;
 
@@ -413,7 +483,7 @@ bool SdcParser::read_driver_info (string& inPortName, string& driverSize, string
   inputTransitionFall = 0.0 ;
   inputTransitionRise = 0.0 ;
   
-  vector<string> tokens ;
+  vector<string_view> tokens ;
   bool valid = read_line_as_tokens (is, tokens) ;
 
   assert (valid) ;
@@ -432,10 +502,10 @@ bool SdcParser::read_driver_info (string& inPortName, string& driverSize, string
     inPortName = tokens[6] ;
 
     assert (tokens[7] == "-input_transition_fall") ;
-    inputTransitionFall = std::atof(tokens[8].c_str()) ;
+    inputTransitionFall = token_to_double(tokens[8]) ;
 
     assert (tokens[9] == "-input_transition_rise") ;
-    inputTransitionRise = std::atof(tokens[10].c_str()) ;    
+    inputTransitionRise = token_to_double(tokens[10]) ;    
 
   } else {
 
@@ -457,14 +527,14 @@ bool SdcParser::read_output_load (string& outPortName, double& load) {
   outPortName = "" ;
   load = 0.0 ;
 
-  vector<string> tokens ;
+  vector<string_view> tokens ;
   bool valid = read_line_as_tokens (is, tokens) ;
 
   if (valid && tokens[0] == "set_load") {
     assert (tokens.size() == 5) ;
 
     assert (tokens[1] == "-pin_load") ;
-    load = std::atof(tokens[2].c_str()) ;
+    load = token_to_double(tokens[2]) ;
 
     assert (tokens[3] == "get_ports") ;
     outPortName = tokens[4] ;
@@ -484,7 +554,7 @@ bool SpefParser::read_connections (vector<SpefConnection>& connections) {
   connections.clear() ; // in case the input is not empty
   bool terminateEarly = false ;
 
-  vector<string> tokens ;
+  vector<string_view> tokens ;
   bool valid = read_line_as_tokens (is, tokens, true /*include special chars*/) ;
   
   // Skip the lines that are not "*CONN"
@@ -544,7 +614,7 @@ void SpefParser::read_capacitances (vector<SpefCapacitance>& capacitances) {
 
   capacitances.clear() ; // in case the input is not empty
 
-  vector<string> tokens ;
+  vector<string_view> tokens ;
   bool valid = true ;
   while (valid) {
     
@@ -567,7 +637,7 @@ void SpefParser::read_capacitances (vector<SpefCapacitance>& capacitances) {
       curr.nodeName.n2 = tokens[tokenIndex++] ;
     }
     
-    curr.capacitance = std::atof(tokens[tokenIndex++].c_str()) ;
+    curr.capacitance = token_to_double(tokens[tokenIndex++]) ;
     assert (curr.capacitance >= 0) ;
 
     capacitances.push_back(curr) ;
@@ -578,7 +648,7 @@ void SpefParser::read_resistances (vector<SpefResistance>& resistances) {
 
   resistances.clear() ; // in case the input is not empty
 
-  vector<string> tokens ;
+  vector<string_view> tokens ;
   bool valid = true ;
   while (valid) {
     
@@ -607,7 +677,7 @@ void SpefParser::read_resistances (vector<SpefResistance>& resistances) {
       curr.toNodeName.n2 = tokens[tokenIndex++] ;
     }
     
-    curr.resistance = std::atof(tokens[tokenIndex++].c_str()) ;
+    curr.resistance = token_to_double(tokens[tokenIndex++]) ;
     assert (curr.resistance >= 0) ;
 
     resistances.push_back(curr) ;
@@ -618,21 +688,21 @@ void SpefParser::read_resistances (vector<SpefResistance>& resistances) {
 // Return value indicates if the last read was successful or not.  
 bool SpefParser::read_net_data (SpefNet& spefNet) {
 
-  //spefNet.clear() ;
+  spefNet.clear() ;
 
-  vector<string> tokens ;
+  vector<string_view> tokens ;
   bool valid = read_line_as_tokens (is, tokens, true /*include special chars*/) ;
 
   // Read until a valid D_NET line is found
   while (valid) {
     if (tokens.size() == 4 && tokens[0] == "*" && tokens[1] == "D_NET") {
-      SpefNets[tokens[2]].netName = tokens[2] ;
-      SpefNets[tokens[2]].netLumpedCap = std::atof(tokens[3].c_str()) ;
+      spefNet.netName = tokens[2] ;
+      spefNet.netLumpedCap = token_to_double(tokens[3]) ;
 
-      bool readConns = read_connections (SpefNets[tokens[2]].connections) ;
+      bool readConns = read_connections (spefNet.connections) ;
       if (readConns) {
-	      read_capacitances (SpefNets[tokens[2]].capacitances) ;
-	      read_resistances (SpefNets[tokens[2]].resistances) ;
+	      read_capacitances (spefNet.capacitances) ;
+	      read_resistances (spefNet.resistances) ;
       }
 
       return true ;
@@ -656,7 +726,7 @@ bool TimingParser::read_timing_line (string& name1, string& name2,
 				     double& riseTransition, double& fallTransition,
 				     double& riseArrival, double& fallArrival) {
 
-  vector<string> tokens ;
+  vector<string_view> tokens ;
   bool valid = read_line_as_tokens (is, tokens) ;
 
   if (!valid)
@@ -672,18 +742,53 @@ bool TimingParser::read_timing_line (string& name1, string& name2,
     name2 = tokens[tokenIndex++] ; 
   }
 
-  riseSlack = std::atof(tokens[tokenIndex++].c_str()) ;
-  fallSlack = std::atof(tokens[tokenIndex++].c_str()) ;
-  riseTransition = std::atof(tokens[tokenIndex++].c_str()) ;
-  fallTransition = std::atof(tokens[tokenIndex++].c_str()) ;
-  riseArrival = std::atof(tokens[tokenIndex++].c_str()) ;
-  fallArrival = std::atof(tokens[tokenIndex++].c_str()) ;
+  riseSlack = token_to_double(tokens[tokenIndex++]) ;
+  fallSlack = token_to_double(tokens[tokenIndex++]) ;
+  riseTransition = token_to_double(tokens[tokenIndex++]) ;
+  fallTransition = token_to_double(tokens[tokenIndex++]) ;
+  riseArrival = token_to_double(tokens[tokenIndex++]) ;
+  fallArrival = token_to_double(tokens[tokenIndex++]) ;
 
   return true ;
   
 }
 
 
+// Read the next assertion.
+// Return value indicates if the last read was successful or not.  
+bool AssertionParser::read_assertion (string& kind, string& port, vector<double>& values) {
+
+  vector<string_view> tokens ;
+
+  // A kind, a port and at least one value, or the line is reported and skipped
+  while (true) {
+
+    bool valid = read_line_as_tokens (is, tokens) ;
+
+    if (!valid)
+      return false ;
+
+    if (tokens.size() >= 3)
+      break ;
+
+    cout << "Error: Malformed assertion line:" ;
+    for (int i=0; i < tokens.size(); ++i)
+      cout << " " << tokens[i] ;
+    cout << endl ;
+  }
+
+  kind = tokens[0] ;
+  port = tokens[1] ;
+
+  values.clear() ;
+  for (int i=2; i < tokens.size(); ++i)
+    values.push_back (token_to_double(tokens[i])) ;
+
+  return true ;
+
+}
+
+
 // Read ceff values for the next pin or port
 // Return value indicates if the last read was successful or not.  
 // If the line read corresponds to a pin, then name1 and name2 will be set to the cell 
@@ -693,7 +798,7 @@ bool TimingParser::read_timing_line (string& name1, string& name2,
 bool CeffParser::read_ceff_line (string& name1, string& name2, double& riseCeff, double& fallCeff) {
 
 
-  vector<string> tokens ;
+  vector<string_view> tokens ;
   bool valid = read_line_as_tokens (is, tokens) ;
 
   if (!valid)
@@ -709,8 +814,8 @@ bool CeffParser::read_ceff_line (string& name1, string& name2, double& riseCeff,
     name2 = tokens[tokenIndex++] ; 
   }
 
-  riseCeff = std::atof(tokens[tokenIndex++].c_str()) ;
-  fallCeff = std::atof(tokens[tokenIndex++].c_str()) ;
+  riseCeff = token_to_double(tokens[tokenIndex++]) ;
+  fallCeff = token_to_double(tokens[tokenIndex++]) ;
 
   return true ;
 }
@@ -719,7 +824,7 @@ bool CeffParser::read_ceff_line (string& name1, string& name2, double& riseCeff,
 // No need to parse the 3D LUTs, because they will be ignored
 void LibParser::_skip_lut_3D () {
 
-  std::vector<string> tokens ;
+  std::vector<string_view> tokens ;
   
   bool valid = read_line_as_tokens (is, tokens) ;
   assert (valid) ;
@@ -756,7 +861,7 @@ void LibParser::_skip_lut_3D () {
 
 void LibParser::_begin_read_lut (LibParserLUT& lut) {
 
-  std::vector<string> tokens ;
+  std::vector<string_view> tokens ;
   bool valid = read_line_as_tokens (is, tokens) ;
 
   assert (valid) ;
@@ -767,7 +872,7 @@ void LibParser::_begin_read_lut (LibParserLUT& lut) {
   lut.loadIndices.resize(size1) ;
   for (int i=0; i < tokens.size()-1; ++i) {
     
-    lut.loadIndices[i] = std::atof(tokens[i+1].c_str()) ;
+    lut.loadIndices[i] = token_to_double(tokens[i+1]) ;
   }
 
   valid = read_line_as_tokens (is, tokens) ;
@@ -780,7 +885,7 @@ void LibParser::_begin_read_lut (LibParserLUT& lut) {
   lut.transitionIndices.resize(size2) ;
   for (int i=0; i < tokens.size()-1; ++i) {
     
-    lut.transitionIndices[i] = std::atof(tokens[i+1].c_str()) ;
+    lut.transitionIndices[i] = token_to_double(tokens[i+1]) ;
   }
 
   valid = read_line_as_tokens (is, tokens) ;
@@ -795,7 +900,7 @@ void LibParser::_begin_read_lut (LibParserLUT& lut) {
 
     lut.tableVals[i].resize(size2) ;
     for (int j=0; j < lut.transitionIndices.size(); ++j) {
-      lut.tableVals[i][j] = std::atof(tokens[j].c_str()) ;
+      lut.tableVals[i][j] = token_to_double(tokens[j]) ;
 
     }
   }
@@ -803,13 +908,13 @@ void LibParser::_begin_read_lut (LibParserLUT& lut) {
   
 }
 
-void LibParser::_begin_read_timing_info (string toPin, LibParserTimingInfo& timing) {
+void LibParser::_begin_read_timing_info (string_view toPin, LibParserTimingInfo& timing) {
 
   timing.toPin = toPin ;
   
   bool finishedReading = false ;
 
-  std::vector<string> tokens ;  
+  std::vector<string_view> tokens ;  
   while (!finishedReading) {
 
     bool valid = read_line_as_tokens (is, tokens) ;
@@ -829,12 +934,10 @@ void LibParser::_begin_read_timing_info (string toPin, LibParserTimingInfo& timi
       _begin_read_lut (timing.riseTransition) ;
 
     } else if (tokens[0] == "fall_constraint") {
-
-      //_skip_lut_3D() ; // will ignore fall constraints      
+      _begin_read_lut (timing.fallConstraint) ;
 
     } else if (tokens[0] == "rise_constraint") {
-
-      //_skip_lut_3D() ; // will ignore rise constraints
+      _begin_read_lut (timing.riseConstraint) ;
 
     } else if (tokens[0] == "timing_sense") {
       timing.timingSense = tokens[1] ;
@@ -851,7 +954,9 @@ void LibParser::_begin_read_timing_info (string toPin, LibParserTimingInfo& timi
       finishedReading = true ;
       
     } else if (tokens[0] == "timing_type") {
-      // ignore data
+
+      assert (tokens.size() == 2) ;
+      timing.timingType = tokens[1] ;
 
     } else if (tokens[0] == "related_output_pin") {
       // ignore data
@@ -868,7 +973,7 @@ void LibParser::_begin_read_timing_info (string toPin, LibParserTimingInfo& timi
 }
 
 
-void LibParser::_begin_read_pin_info (string pinName, LibParserCellInfo& cell, LibParserPinInfo& pin) {
+void LibParser::_begin_read_pin_info (string_view pinName, LibParserCellInfo& cell, LibParserPinInfo& pin) {
 
   pin.name = pinName ;
   pin.isClock = false ;
@@ -876,7 +981,7 @@ void LibParser::_begin_read_pin_info (string pinName, LibParserCellInfo& cell, L
   
   bool finishedReading = false ;
 
-  std::vector<string> tokens ;  
+  std::vector<string_view> tokens ;  
   while (!finishedReading) {
 
     bool valid = read_line_as_tokens (is, tokens) ;
@@ -896,12 +1001,12 @@ void LibParser::_begin_read_pin_info (string pinName, LibParserCellInfo& cell, L
     } else if (tokens[0] == "capacitance") {
 
       assert (tokens.size() == 2) ;
-      pin.capacitance = std::atof(tokens[1].c_str()) ;
+      pin.capacitance = token_to_double(tokens[1]) ;
 
     } else if (tokens[0] == "max_capacitance") {
 
       assert (tokens.size() == 2) ;
-      pin.maxCapacitance = std::atof(tokens[1].c_str()) ;
+      pin.maxCapacitance = token_to_double(tokens[1]) ;
 
 
     } else if (tokens[0] == "timing") {
@@ -942,7 +1047,7 @@ void LibParser::_begin_read_pin_info (string pinName, LibParserCellInfo& cell, L
 
 }
 
-void LibParser::_begin_read_cell_info (string cellName, LibParserCellInfo& cell) {
+void LibParser::_begin_read_cell_info (string_view cellName, LibParserCellInfo& cell) {
 
   cell.name = cellName ;
   cell.isSequential = false ;
@@ -950,7 +1055,7 @@ void LibParser::_begin_read_cell_info (string cellName, LibParserCellInfo& cell)
   
   bool finishedReading = false ;
 
-  std::vector<string> tokens ;  
+  std::vector<string_view> tokens ;  
   while (!finishedReading) {
 
     bool valid = read_line_as_tokens (is, tokens) ;
@@ -960,7 +1065,7 @@ void LibParser::_begin_read_cell_info (string cellName, LibParserCellInfo& cell)
     if (tokens[0] == "cell_leakage_power") {
 
       assert (tokens.size() == 2) ;
-      cell.leakagePower = std::atof(tokens[1].c_str()) ;
+      cell.leakagePower = token_to_double(tokens[1]) ;
 
     } else if (tokens[0] == "cell_footprint") {
         
@@ -970,7 +1075,7 @@ void LibParser::_begin_read_cell_info (string cellName, LibParserCellInfo& cell)
     } else if (tokens[0] == "area") {
 
       assert (tokens.size() == 2) ;
-      cell.area = std::atof(tokens[1].c_str()) ;
+      cell.area = token_to_double(tokens[1]) ;
 
     } else if (tokens[0] == "clocked_on") {
 
@@ -1026,14 +1131,14 @@ void LibParser::_begin_read_cell_info (string cellName, LibParserCellInfo& cell)
 bool LibParser::read_default_max_transition (double& maxTransition) {
 
   maxTransition = 0.0 ;
-  vector<string> tokens ;
+  vector<string_view> tokens ;
 
   bool valid = read_line_as_tokens (is, tokens) ;
 
   while (valid) {
 
     if (tokens.size() == 2 && tokens[0] == "default_max_transition") {
-      maxTransition = std::atof(tokens[1].c_str()) ;
+      maxTransition = token_to_double(tokens[1]) ;
       return true ;
     }
 
@@ -1049,7 +1154,7 @@ bool LibParser::read_default_max_transition (double& maxTransition) {
 // Return value indicates if the last read was successful or not.  
 bool LibParser::read_cell_info (LibParserCellInfo& cell) {
 
-  vector<string> tokens ;
+  vector<string_view> tokens ;
   bool valid = read_line_as_tokens (is, tokens) ;
 
 
@@ -1103,6 +1208,7 @@ ostream& operator<< (ostream& os, LibParserTimingInfo& timing) {
 
   cout << "Timing info from " << timing.fromPin << " to " << timing.toPin << ": " << endl ;
   cout << "Timing sense: " << timing.timingSense << endl ;
+  cout << "Timing type: " << timing.timingType << endl ;
 
   cout << "Fall delay LUT: " << endl ;
   cout << timing.fallDelay ;
@@ -1116,6 +1222,12 @@ ostream& operator<< (ostream& os, LibParserTimingInfo& timing) {
   cout << "Rise transition LUT: " << endl ;
   cout << timing.riseTransition ;
 
+  cout << "Fall constraint LUT: " << endl ;
+  cout << timing.fallConstraint ;
+
+  cout << "Rise constraint LUT: " << endl ;
+  cout << timing.riseConstraint ;
+
   return os ;
 }
 
@@ -1314,6 +1426,12 @@ void test_spef_parser (string filename) {
   //int readCnt = 0 ;
   while (valid) {
 
+    if (SpefStreaming)
+      reduce_spef_net (spefNet) ;
+    else
+      index_spef_net (spefNet) ;
+    SpefNets[spefNet.netName] = spefNet ;
+
     //++readCnt ;
 
     // print out the contents of the spefNet just read
@@ -1342,6 +1460,86 @@ void test_spef_parser (string filename) {
   //cout << "Read " << readCnt << " nets in the spef file." << endl ;
 }
 
+// Find the offsets of all the "*D_NET" keywords that start a line.
+// Every worker scans a slice of the file; a match belongs to the slice it starts in.
+static void find_dnet_offsets (const MappedFile& file, vector<size_t>& offsets) {
+
+  static const string_view keyword ("*D_NET") ;
+
+  const char* begin = file.begin() ;
+  size_t size = file.end() - file.begin() ;
+  size_t numSlices = std::max<size_t> (1, std::min<size_t> (thread_pool().size() * 4, size >> 20)) ;
+  size_t sliceSize = size / numSlices + 1 ;
+  vector<vector<size_t> > sliceOffsets (numSlices) ;
+
+  thread_pool().parallel_for (numSlices, [&] (size_t slice) {
+
+    string_view text (begin, size) ;
+    size_t pos = slice * sliceSize ;
+    size_t sliceEnd = std::min (pos + sliceSize, size) ;
+
+    while ((pos = text.find (keyword, pos)) != string_view::npos && pos < sliceEnd) {
+      if (pos == 0 || text[pos-1] == '\n')
+        sliceOffsets[slice].push_back (pos) ;
+      pos += keyword.size() ;
+    }
+  }) ;
+
+  offsets.clear() ;
+  for (size_t i=0; i < numSlices; ++i)
+    offsets.insert (offsets.end(), sliceOffsets[i].begin(), sliceOffsets[i].end()) ;
+}
+
+void read_spef_parallel (string filename, vector<string>* netNames) {
+
+  MappedFile file (filename) ;
+  if (!file.is_open())
+    return ;
+
+  vector<size_t> offsets ;
+  find_dnet_offsets (file, offsets) ;
+
+  if (offsets.empty())
+    return ;
+
+  // A few chunks per thread so that uneven nets even out
+  size_t numChunks = std::min (offsets.size(), (size_t) thread_pool().size() * 8) ;
+  size_t netsPerChunk = (offsets.size() + numChunks - 1) / numChunks ;
+  numChunks = (offsets.size() + netsPerChunk - 1) / netsPerChunk ;
+
+  vector<vector<SpefNet> > chunkNets (numChunks) ;
+
+  thread_pool().parallel_for (numChunks, [&] (size_t chunk) {
+
+    size_t first = chunk * netsPerChunk ;
+    size_t last = std::min (first + netsPerChunk, offsets.size()) ;
+    const char* chunkEnd = (last == offsets.size()) ? file.end() : file.begin() + offsets[last] ;
+
+    SpefParser sp (file.begin() + offsets[first], chunkEnd) ;
+    vector<SpefNet>& nets = chunkNets[chunk] ;
+    nets.reserve (last - first) ;
+
+    SpefNet spefNet ;
+    while (sp.read_net_data (spefNet)) {
+      if (SpefStreaming)
+        reduce_spef_net (spefNet) ;
+      else
+        index_spef_net (spefNet) ;
+      nets.push_back (std::move (spefNet)) ;
+    }
+  }) ;
+
+  // Merge in file order, so a net defined twice keeps its last definition
+  SpefNets.reserve (SpefNets.size() + offsets.size()) ;
+  for (size_t i=0; i < numChunks; ++i) {
+    for (auto it = chunkNets[i].begin(); it != chunkNets[i].end(); ++it) {
+      if (netNames != nullptr)
+        netNames->push_back (it->netName) ;
+      SpefNets[it->netName] = std::move (*it) ;
+    }
+  }
+}
+
 // Example function that uses TimingParser class to parse the given ISPD-13 timing
 // file. The extracted data is simply printed out in this example.
 void test_timing_parser (string filename) {
@@ -1381,6 +1579,58 @@ void test_timing_parser (string filename) {
 }
 
 
+// Read the TAU 2015 timing assertions. Arrival times and slews go to the
+// PIs table, required arrival times to the POs table.
+void read_timing_assertions (string filename) {
+
+  AssertionParser ap (filename) ;
+
+  string kind, port ;
+  vector<double> values ;
+
+  while (ap.read_assertion (kind, port, values)) {
+
+    if (kind == "clock") {
+      ClockPort = port ;
+      ClockPeriod = values[0] ;
+      continue ;
+    }
+
+    if (values.size() != 4) {
+      cout << "Error: Malformed assertion for " << port << endl ;
+      continue ;
+    }
+
+    if (kind == "at") {
+      pi_values& pi = PIs[port] ;
+      pi.early_rise_at = values[0] ;
+      pi.early_fall_at = values[1] ;
+      pi.late_rise_at = values[2] ;
+      pi.late_fall_at = values[3] ;
+    }
+    else if (kind == "slew") {
+      pi_values& pi = PIs[port] ;
+      pi.tr_r_early = values[0] ;
+      pi.tr_f_early = values[1] ;
+      pi.tr_r_late = values[2] ;
+      pi.tr_f_late = values[3] ;
+    }
+    else if (kind == "rat") {
+      po_values& po = POs[port] ;
+      po.early_rise_rat = values[0] ;
+      po.early_fall_rat = values[1] ;
+      po.late_rise_rat = values[2] ;
+      po.late_fall_rat = values[3] ;
+      po.isConstrained = true ;
+    }
+    else {
+      cout << "Error: Unknown assertion: " << kind << endl ;
+    }
+  }
+
+}
+
+
 // Example function that uses CeffParser class to parse the given ISPD-13 ceff
 // file. The extracted data is simply printed out in this example.
 void test_ceff_parser (string filename) {
@@ -1416,6 +1666,34 @@ void test_ceff_parser (string filename) {
 
 
 
+static TimingSense decode_timing_sense (const string& sense) {
+
+  if (sense == "positive_unate")
+    return POSITIVE_UNATE ;
+  if (sense == "negative_unate")
+    return NEGATIVE_UNATE ;
+  return NON_UNATE ;
+}
+
+void index_cells () {
+
+  for (auto it = Cells.begin(); it != Cells.end(); ++it) {
+
+    LibParserCellInfo& cell = it->second ;
+    cell.pinIndex.clear() ;
+    cell.arcsFrom.clear() ;
+
+    for (int i=0; i < cell.pins.size(); ++i)
+      cell.pinIndex.emplace (cell.pins[i].name, i) ;
+
+    for (int i=0; i < cell.timingArcs.size(); ++i) {
+      cell.arcsFrom[cell.timingArcs[i].fromPin].push_back (i) ;
+      cell.timingArcs[i].sense = decode_timing_sense (cell.timingArcs[i].timingSense) ;
+    }
+  }
+}
+
+
 // Example function that uses LibParser class to parse the given ISPD-13 lib
 // file. The extracted data is simply printed out in this example.
 void test_lib_parser (string filename) {
@@ -1461,7 +1739,7 @@ int wake_parser(string filetype, string filename) {
   }
   else if (filetype == string("spef")) {
     //cout << "Parsing spef..." << endl ;  
-    test_spef_parser (filename) ;
+    read_spef_parallel (filename) ;
     cout << "Finished parsing spef." << endl ;
   }
   else if (filetype == string("timing")) {
@@ -1469,6 +1747,10 @@ int wake_parser(string filetype, string filename) {
     test_timing_parser (filename) ;
     cout << "Finished parsing timing." << endl ;
   }
+  else if (filetype == string("assertions")) {
+    read_timing_assertions (filename) ;
+    cout << "Finished parsing timing assertions." << endl ;
+  }
   else if (filetype == string("ceff")) {
     cout << "Parsing ceff..." << endl ;  
     test_ceff_parser (filename) ;
@@ -1476,8 +1758,15 @@ int wake_parser(string filetype, string filename) {
   }
   else if (filetype == string("lib")) {
     //cout << "Parsing lib..." << endl ;
-    test_lib_parser (filename) ;
-    cout << "Finished parsing lib." << endl ;
+    if (read_lib_cache (filename)) {
+      cout << "Loaded lib from cache." << endl ;
+    } else {
+      test_lib_parser (filename) ;
+      if (UseLibCache)
+        write_lib_cache (filename) ;
+      cout << "Finished parsing lib." << endl ;
+    }
+    index_cells () ;
   }
   else {
     cout << "Unknown format " << filetype << endl ;
@@ -26,8 +26,10 @@
 #include <fstream>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <limits>
 #include <unordered_map>
+#include "interner.h"
 
 using std::cout ;
 using std::endl ;
@@ -35,6 +37,61 @@ using std::istream ;
 using std::ostream ;
 using std::vector ;
 using std::string ;
+using std::string_view ;
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// Read-only memory mapping of an input file. The parsers below do not
+// copy the file into std::strings; they walk the mapping with a
+// TokenStream and get back string_views that point into it. The
+// mapping must therefore outlive every token read from it.
+//
+/////////////////////////////////////////////////////////////////////
+class MappedFile {
+
+  const char* data ;
+  size_t size ;
+
+  MappedFile (const MappedFile&) = delete ;
+  MappedFile& operator= (const MappedFile&) = delete ;
+
+public:
+
+  // Maps the given file. A missing or empty file gives an empty range.
+  MappedFile () : data (nullptr), size (0) {}
+  MappedFile (string filename) ;
+  ~MappedFile () ;
+
+  bool is_open () const { return data != nullptr ; }
+  const char* begin () const { return data ; }
+  const char* end () const { return data + size ; }
+
+} ;
+
+
+// Cursor over a [begin, end) range of a mapped file
+class TokenStream {
+
+  const char* curr ;
+  const char* last ;
+
+public:
+
+  TokenStream (const char* begin, const char* end): curr(begin), last(end) {}
+
+  const char* position () const { return curr ; }
+  bool eof () const { return curr >= last ; }
+
+  // Read the next non empty line and split it into tokens, skipping white space.
+  // Special characters are returned as single character tokens if requested.
+  // The return value indicates success/failure.
+  bool read_line_as_tokens (vector<string_view>& tokens, bool includeSpecialChars = false) ;
+
+} ;
+
+// Convert a numeric token. Like std::atof, invalid input gives 0.0
+double token_to_double (string_view token) ;
 
 
 /////////////////////////////////////////////////////////////////////
@@ -49,13 +106,14 @@ using std::string ;
 /////////////////////////////////////////////////////////////////////
 class VerilogParser {
 
-  std::ifstream is ;
+  MappedFile file ;
+  TokenStream is ;
   
 public:
 
 
   // Constructor that opens the given filename
-  VerilogParser (string filename): is(filename.c_str()) {}
+  VerilogParser (string filename): file(filename), is(file.begin(), file.end()) {}
 
   // The following functions must be issued in a particular order
   // See test_verilog_parser function for an example
@@ -96,13 +154,14 @@ public:
 /////////////////////////////////////////////////////////////////////
 class SdcParser {
 
-  std::ifstream is ;
+  MappedFile file ;
+  TokenStream is ;
   
 public:
 
 
   // Constructor that opens the given filename
-  SdcParser (string filename): is(filename.c_str()) {} 
+  SdcParser (string filename): file(filename), is(file.begin(), file.end()) {} 
 
   // The following functions must be issued in a particular order
   // See test_sdc_parser function for an example
@@ -196,6 +255,13 @@ inline ostream& operator<< (ostream& os, const SpefResistance& r) {
   return os ;
 }
 
+// Cached delay of a receiver, computed from the RC tree when the net is loaded
+// (see index_spef_net)
+struct SpefSinkDelay {
+  SpefNodeName nodeName ;
+  double delay ; // Elmore delay from the driver (first moment)
+} ;
+
 struct SpefNet {
 
   string netName ;
@@ -204,19 +270,29 @@ struct SpefNet {
   vector<SpefCapacitance> capacitances ;
   vector<SpefResistance> resistances ;
 
+  // The per-sink delays are computed right after parsing. In streaming
+  // mode the RC detail above is dropped then and only they are kept.
+  bool isReduced ;
+  vector<SpefSinkDelay> sinkDelays ;
+
+  SpefNet () : netLumpedCap (0.0), isReduced (false) {}
+
   void clear() {
     netName = "" ;
     netLumpedCap = 0.0 ;
     connections.clear() ;
     capacitances.clear() ;
     resistances.clear() ;
+    isReduced = false ;
+    sinkDelays.clear() ;
   }
 
 } ;
 
 class SpefParser {
 
-  std::ifstream is ;
+  MappedFile file ;
+  TokenStream is ;
   
   bool read_connections (vector<SpefConnection>& connections) ;
   void read_capacitances (vector<SpefCapacitance>& capacitances) ;
@@ -224,7 +300,11 @@ class SpefParser {
 
 public:
 
-  SpefParser (string filename): is(filename.c_str()) {}
+  SpefParser (string filename): file(filename), is(file.begin(), file.end()) {}
+
+  // Parse only the [begin, end) part of an already mapped file.
+  // Used by the parallel loader, which hands each worker a range of *D_NETs.
+  SpefParser (const char* begin, const char* end): is(begin, end) {}
 
   // Read the spef data for the next net.
   // Return value indicates if the last read was successful or not.  
@@ -245,11 +325,12 @@ public:
 /////////////////////////////////////////////////////////////////////
 class TimingParser {
 
-  std::ifstream is ;
+  MappedFile file ;
+  TokenStream is ;
   
 public:
 
-  TimingParser (string filename): is(filename.c_str()) {}
+  TimingParser (string filename): file(filename), is(file.begin(), file.end()) {}
 
   // Read timing info for the next pin or port
   // Return value indicates if the last read was successful or not.  
@@ -266,6 +347,35 @@ public:
 
 
 
+/////////////////////////////////////////////////////////////////////
+// 
+// This class can be used to parse the timing assertions (.timing)
+// file of the TAU 2015 contest benchmarks.
+//
+// See read_timing_assertions () function in parser_helper.cpp for an
+// example of how to use this class.
+// 
+/////////////////////////////////////////////////////////////////////
+class AssertionParser {
+
+  MappedFile file ;
+  TokenStream is ;
+  
+public:
+
+  AssertionParser (string filename): file(filename), is(file.begin(), file.end()) {}
+
+  // Read the next assertion.
+  // Return value indicates if the last read was successful or not.  
+  // kind is "clock", "at", "slew" or "rat" and port is the port it applies to.
+  // For a clock, values holds the period. Otherwise it holds the early rise,
+  // early fall, late rise and late fall values, in this order.
+  bool read_assertion (string& kind, string& port, vector<double>& values) ;
+
+} ;
+
+
+
 /////////////////////////////////////////////////////////////////////
 // 
 // This class can be used to parse the specific .ceff
@@ -277,11 +387,12 @@ public:
 /////////////////////////////////////////////////////////////////////
 class CeffParser {
 
-  std::ifstream is ;
+  MappedFile file ;
+  TokenStream is ;
   
 public:
 
-  CeffParser (string filename): is(filename.c_str()) {}
+  CeffParser (string filename): file(filename), is(file.begin(), file.end()) {}
 
   // Read ceff values for the next pin or port
   // Return value indicates if the last read was successful or not.  
@@ -324,6 +435,9 @@ struct LibParserLUT {
 
 ostream& operator<< (ostream& os, LibParserLUT& lut) ;
 
+// Timing sense of an arc, decoded from its timingSense string by index_cells
+enum TimingSense { POSITIVE_UNATE, NEGATIVE_UNATE, NON_UNATE } ;
+
 struct LibParserTimingInfo {
 
   string fromPin ;
@@ -332,6 +446,8 @@ struct LibParserTimingInfo {
   // Note that ISPD-13 library will have only negative-unate combinational cells. The clock arcs
   // for sequentials will be non_unate (which can be ignored because of the simplified sequential
   // timing model for ISPD-13).
+  TimingSense sense ;
+  string timingType ; // "setup_rising", "hold_rising", ... or "" when the lib gives none
 
   
   LibParserLUT fallDelay ;
@@ -339,6 +455,13 @@ struct LibParserTimingInfo {
   LibParserLUT fallTransition ;
   LibParserLUT riseTransition ;
 
+  // Setup and hold checks of a falling or rising toPin against fromPin.
+  // index_1 is the toPin (data) transition, index_2 the fromPin (clock) one.
+  LibParserLUT fallConstraint ;
+  LibParserLUT riseConstraint ;
+
+  LibParserTimingInfo () : sense (NON_UNATE) {}
+
 } ;
 
 ostream& operator<< (ostream& os, LibParserTimingInfo& timing) ;
@@ -370,7 +493,18 @@ struct LibParserCellInfo {
   vector<LibParserPinInfo> pins ;
   vector<LibParserTimingInfo> timingArcs ;
 
+  // Built by index_cells once the library is loaded, so that pins and
+  // arcs are found without scanning the lists above
+  std::unordered_map <string, int> pinIndex ; // pin name -> position in pins
+  std::unordered_map <string, vector<int> > arcsFrom ; // fromPin -> positions in timingArcs
+
   LibParserCellInfo () : leakagePower (0.0), area (0.0), isSequential (false), dontTouch(false) {}
+
+  // nullptr if the cell has no such pin
+  const LibParserPinInfo* find_pin (const string& pinName) const {
+    auto it = pinIndex.find (pinName) ;
+    return (it == pinIndex.end()) ? nullptr : &pins[it->second] ;
+  }
   
 } ;
 
@@ -398,6 +532,10 @@ struct NetPin {
   string pinName ; 
   string cellType ;
 
+  PinId pin ; // filled in by create_graph
+
+  NetPin () : pin (INVALID_ID) {}
+
 };
 
 struct po_values {
@@ -411,8 +549,9 @@ struct po_values {
   double tr_r_late;
   double tr_f_late;
   NetPin linkedBy ;
+  bool isConstrained ; // a rat assertion was read for this port
 
-  po_values () : early_rise_rat (0.0), early_fall_rat (0.0), late_rise_rat (0.0), late_fall_rat (0.0) {}
+  po_values () : early_rise_rat (0.0), early_fall_rat (0.0), late_rise_rat (0.0), late_fall_rat (0.0), isConstrained (false) {}
 
 } ;
 
@@ -438,63 +577,84 @@ struct NetParserInfo {
   string name ;  // net name
   bool isPrimaryIn;
   bool isPrimaryOut;
+  bool isCellArc; // not a real net, connects a cell input to the outputs it drives
   NetPin output ;  // output pin name, we only have one
   vector <NetPin> inputs ; // input pins, we may have more than one
 
-  NetParserInfo () : isPrimaryIn(false), isPrimaryOut(false) {}
+  NetParserInfo () : isPrimaryIn(false), isPrimaryOut(false), isCellArc(false) {}
 
 } ;
 
 struct VerParserPinInfo {
 
-  double at_early ;
-  double at_late ;
-  double rat_early ;
-  double rat_late ;
+  double at_r_early ;
+  double at_f_early ;
+  double at_r_late ;
+  double at_f_late ;
+  double rat_r_early ;
+  double rat_f_early ;
+  double rat_r_late ;
+  double rat_f_late ;
+  double slack_early ; // worst of rise and fall, set by the backward pass
+  double slack_late ;
   double tr_r_early;
   double tr_f_early;
   double tr_r_late;
   double tr_f_late;
   bool isInput ;
   string connNetName ; // store net name that connects an output pin with an input. We'll need it for the Net key
-  vector<NetPin> linksTo ;
-  vector<NetPin> linkedBy ;
-
-  VerParserPinInfo () : at_early (0.0), at_late (0.0), rat_early (0.0), rat_late (0.0), isInput (false) {}
+  CellId cell ; // library cell of the instance, INVALID_ID for ports
+  const LibParserPinInfo* libPin ; // pin of that cell, nullptr for ports
+  NetId net ; // id of connNetName
+  string instance_name ; // empty for ports
+  string pinName ; // library pin name, or the port name
+  bool fwdDirty ; // waiting for update_timing to re-time its arrival
+  bool bwdDirty ; // waiting for update_timing to re-time its required time
+  bool atValid ; // lazy timing: arrival is up to date
+  unsigned int ratStamp ; // lazy timing: required time is up to date while it equals the current stamp
+
+  VerParserPinInfo () : at_r_early (0.0), at_f_early (0.0), at_r_late (0.0), at_f_late (0.0), rat_r_early (0.0), rat_f_early (0.0), rat_r_late (0.0), rat_f_late (0.0),
+                        slack_early (0.0), slack_late (0.0), tr_r_early (0.0), tr_f_early (0.0),
+                        tr_r_late (0.0), tr_f_late (0.0), isInput (false), cell (INVALID_ID), libPin (nullptr), net (INVALID_ID),
+                        fwdDirty (false), bwdDirty (false), atValid (false), ratStamp (0) {}
 
 } ;
 
-/* Net structure. Every net must be different in order to *
- * have different delays.                                 */
+/* Graph edge. Either a wire from a net driver to one of its sinks *
+ * (net is set) or an in-cell timing arc (arc is set). Every edge   *
+ * must be different in order to have different delays.            */
 struct NetsInfo {
 
-  string netName;
-  NetPin fromPin;
-  NetPin toPin;
+  PinId fromPin;
+  PinId toPin;
+  NetId net;
+  ArcId arc;
   double delay;
   double dr_EARLY;
   double df_EARLY;
   double dr_LATE;
   double df_LATE;
 
-  NetsInfo () : delay (0.0) {}
+  NetsInfo () : fromPin (INVALID_ID), toPin (INVALID_ID), net (INVALID_ID), arc (INVALID_ID), delay (0.0),
+                dr_EARLY (0.0), df_EARLY (0.0), dr_LATE (0.0), df_LATE (0.0) {}
 } ;
 
 // See test_lib_parser () function in parser_helper.cpp for an
 // example of how to use this class.
 class LibParser {
 
-  std::ifstream is ;
+  MappedFile file ;
+  TokenStream is ;
 
   void _skip_lut_3D () ;
   void _begin_read_lut (LibParserLUT& lut) ;
-  void _begin_read_timing_info (string pinName, LibParserTimingInfo& cell) ;
-  void _begin_read_pin_info (string pinName, LibParserCellInfo& cell, LibParserPinInfo& pin) ;
-  void _begin_read_cell_info (string cellName, LibParserCellInfo& cell) ;
+  void _begin_read_timing_info (string_view pinName, LibParserTimingInfo& cell) ;
+  void _begin_read_pin_info (string_view pinName, LibParserCellInfo& cell, LibParserPinInfo& pin) ;
+  void _begin_read_cell_info (string_view cellName, LibParserCellInfo& cell) ;
   
 public:
 
-  LibParser (string filename): is(filename.c_str()) {}
+  LibParser (string filename): file(filename), is(file.begin(), file.end()) {}
 
   // Read the default max_transition defined for the library.
   // Return value indicates if the last read was successful or not.  
@@ -512,6 +672,26 @@ public:
 
 int wake_parser(string filetype, string filename);
 
+// Build the pin and arc indices of every cell in Cells and decode the
+// timing senses of the arcs
+void index_cells();
+
+// Reduce every spef net to its sink delays while parsing (-spef_stream)
+extern bool SpefStreaming ;
+
+// Parse the spef file on the worker pool and store the nets to SpefNets.
+// The file is split on *D_NET boundaries and every chunk is parsed into
+// a buffer of its own, so the global table is only touched in the merge.
+// The names of the nets read are appended to netNames if it is given.
+void read_spef_parallel(string filename, vector<string>* netNames = nullptr);
+
+// Store the at/slew assertions to PIs and the rat assertions to POs
+void read_timing_assertions(string filename);
+
+// Clock port and period from the assertions file
+extern string ClockPort ;
+extern double ClockPeriod ;
+
 
 // Initialize hash tables for cells, nets and pins
 extern std::unordered_map <string, LibParserCellInfo> Cells;
@@ -519,7 +699,6 @@ extern std::unordered_map <string, VerParserPinInfo> Pins;
 extern std::unordered_map <string, pi_values> PIs;  // primary inputs
 extern std::unordered_map <string, po_values> POs;  // primary outputs
 extern std::unordered_map <string, NetParserInfo> NetsHelper; // Helper hash table in order to temporary store the pins' connections
-extern std::unordered_map <string, NetsInfo> Nets;
 extern std::unordered_map <string, SpefNet> SpefNets; // Store spef file
 
 #endif
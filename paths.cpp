@@ -0,0 +1,380 @@
+#include <iostream>
+#include <vector>
+#include <queue>
+#include <cmath>
+#include <algorithm>
+#include "parser_helper.h"
+#include "graph.h"
+#include "cppr.h"
+#include "paths.h"
+
+/* Paths are enumerated the way Eppstein enumerates k shortest paths. A *
+ * state is a pin with a transition. The worst path into a state follows *
+ * the worst fanin of every state back to a start point; any other path  *
+ * is that path with some deviations, each taking another fanin at one   *
+ * state for the difference in arrival as its cost. The deviations along *
+ * the worst path from every state sit in a persistent leftist heap that *
+ * shares its nodes with the heap of the next state, so all of them are  *
+ * built in O(n log n) and a path has at most three successors.          */
+struct DeviationNode {
+
+  double cost;
+  unsigned int from;      // state where the path leaves its worst fanin
+  unsigned int to;        // state it goes to instead
+  unsigned int left;
+  unsigned int right;
+  unsigned int rank;
+
+};
+
+/* Path in the enumeration queue: its parent path plus the deviation in *
+ * node. The worst path into an endpoint state has neither.             */
+struct PathEntry {
+
+  double slack;
+  unsigned int parent;
+  unsigned int node;
+  unsigned int state;
+
+};
+
+static vector<DeviationNode> Deviations;
+
+static unsigned int rank_of( unsigned int h ) {
+  return ( h == INVALID_ID ) ? 0 : Deviations[h].rank;
+}
+
+/* Merge two heaps without changing either of them */
+static unsigned int merge_heaps( unsigned int a, unsigned int b ) {
+
+  if ( a == INVALID_ID )
+    return b;
+  if ( b == INVALID_ID )
+    return a;
+
+  if ( Deviations[b].cost < Deviations[a].cost )
+    std::swap( a, b );
+
+  unsigned int copy = Deviations.size();
+  Deviations.push_back( Deviations[a] );
+
+  unsigned int right = merge_heaps( Deviations[copy].right, b );
+  Deviations[copy].right = right;
+
+  if ( rank_of( Deviations[copy].left ) < rank_of( right ) ) {
+    Deviations[copy].right = Deviations[copy].left;
+    Deviations[copy].left = right;
+  }
+  Deviations[copy].rank = rank_of( Deviations[copy].right ) + 1;
+
+  return copy;
+
+}
+
+static inline unsigned int state_of( PinId pin, bool rise ) {
+  return 2 * pin + ( rise ? 1 : 0 );
+}
+
+/* Arrival a fanin offers to a pin */
+struct FaninArrival {
+
+  PinId pin;
+  bool rise;
+  double arrival;
+
+};
+
+static double arrival( const VerParserPinInfo& pin, bool rise, bool late ) {
+
+  if ( late )
+    return rise ? pin.at_r_late : pin.at_f_late;
+  return rise ? pin.at_r_early : pin.at_f_early;
+
+}
+
+/* The arrivals every fanin edge and input transition give to (pin, rise), *
+ * computed the way the forward pass does. Returns the index of the worst  *
+ * one, -1 if the pin is a start point.                                    */
+static int fanin_arrivals( PinId pin, bool rise, bool late, vector<FaninArrival>& fanins ) {
+
+  fanins.clear();
+
+  /* Data paths start at the flip flop clock pins */
+  if ( is_clock_pin( pin ) )
+    return -1;
+
+  for ( EdgeId i = FaninBegin[pin]; i < FaninBegin[pin + 1]; i++ ) {
+
+    const NetsInfo& edge = EdgeTable[FaninEdges[i]];
+    const VerParserPinInfo& prev = PinTable[edge.fromPin];
+
+    if ( !is_timing_edge( edge ) || !is_timed( prev ) )
+      continue;
+
+    FaninArrival f;
+    f.pin = edge.fromPin;
+
+    /* Wire */
+    if ( edge.net != INVALID_ID ) {
+      f.rise = rise;
+      f.arrival = arrival( prev, rise, late ) + edge.delay;
+      fanins.push_back( f );
+      continue;
+    }
+
+    double delay;
+    if ( late )
+      delay = rise ? edge.dr_LATE : edge.df_LATE;
+    else
+      delay = rise ? edge.dr_EARLY : edge.df_EARLY;
+
+    TimingSense sense = ArcTable[edge.arc]->sense;
+
+    /* Non unate arcs pass either input transition */
+    if ( sense == NON_UNATE ) {
+      f.rise = !rise;
+      f.arrival = arrival( prev, !rise, late ) + delay;
+      fanins.push_back( f );
+    }
+
+    f.rise = ( sense == NEGATIVE_UNATE ) ? !rise : rise;
+    f.arrival = arrival( prev, f.rise, late ) + delay;
+    fanins.push_back( f );
+  }
+
+  int worst = -1;
+
+  for ( int i = 0; i < (int) fanins.size(); i++ )
+    if ( worst < 0 || ( late ? fanins[i].arrival > fanins[worst].arrival : fanins[i].arrival < fanins[worst].arrival ) )
+      worst = i;
+
+  return worst;
+
+}
+
+static bool is_endpoint( PinId p ) {
+
+  for ( EdgeId e = FanoutBegin[p]; e < FanoutBegin[p + 1]; e++ )
+    if ( is_timing_edge( EdgeTable[e] ) )
+      return false;
+
+  return true;
+
+}
+
+/* Pins and transitions of a path. worst holds the worst fanin state of *
+ * every state.                                                        */
+static void materialize( const vector<PathEntry>& entries, unsigned int index,
+                         const vector<unsigned int>& worst, TimingPath& path ) {
+
+  /* Deviations of the path, the one closest to the endpoint first */
+  vector<unsigned int> taken;
+  unsigned int e = index;
+
+  for ( ; entries[e].node != INVALID_ID; e = entries[e].parent )
+    taken.push_back( entries[e].node );
+  std::reverse( taken.begin(), taken.end() );
+
+  unsigned int state = entries[e].state;
+  unsigned int next = 0;
+
+  path.slack = entries[index].slack;
+  path.pins.clear();
+  path.rise.clear();
+
+  while ( state != INVALID_ID ) {
+
+    path.pins.push_back( state / 2 );
+    path.rise.push_back( state % 2 );
+
+    if ( next < taken.size() && Deviations[taken[next]].from == state )
+      state = Deviations[taken[next++]].to;
+    else
+      state = worst[state];
+  }
+
+  std::reverse( path.pins.begin(), path.pins.end() );
+  std::reverse( path.rise.begin(), path.rise.end() );
+
+}
+
+vector<TimingPath> report_worst_paths( unsigned int K, bool late, PinId endpoint ) {
+
+  vector<TimingPath> paths;
+  vector<FaninArrival> fanins;
+
+  unsigned int numStates = 2 * PinTable.size();
+  vector<unsigned int> worst( numStates, INVALID_ID );
+  vector<unsigned int> heap( numStates, INVALID_ID );
+
+  Deviations.clear();
+  ensure_timing( endpoint );
+
+  /* Worst fanin and deviation heap of every state, fanins first */
+  for ( PinId i = 0; i < LevelPins.size(); i++ ) {
+
+    PinId pin = LevelPins[i];
+    if ( !is_timed( PinTable[pin] ) )
+      continue;
+
+    for ( int r = 0; r < 2; r++ ) {
+
+      unsigned int state = state_of( pin, r );
+      int w = fanin_arrivals( pin, r, late, fanins );
+
+      if ( w < 0 )
+        continue;
+
+      unsigned int own = INVALID_ID;
+
+      for ( int f = 0; f < (int) fanins.size(); f++ ) {
+
+        if ( f == w )
+          continue;
+
+        DeviationNode node;
+        node.cost = std::abs( fanins[w].arrival - fanins[f].arrival );
+        node.from = state;
+        node.to = state_of( fanins[f].pin, fanins[f].rise );
+        node.left = node.right = INVALID_ID;
+        node.rank = 1;
+
+        Deviations.push_back( node );
+        own = merge_heaps( own, Deviations.size() - 1 );
+      }
+
+      worst[state] = state_of( fanins[w].pin, fanins[w].rise );
+      heap[state] = merge_heaps( own, heap[worst[state]] );
+    }
+  }
+
+  vector<PathEntry> entries;
+
+  typedef std::pair<double, unsigned int> HeapEntry;
+  std::priority_queue< HeapEntry, vector<HeapEntry>, std::greater<HeapEntry> > queue;
+
+  /* The worst path into every endpoint and transition */
+  PinId first = ( endpoint == INVALID_ID ) ? 0 : endpoint;
+  PinId last = ( endpoint == INVALID_ID ) ? PinTable.size() : endpoint + 1;
+
+  for ( PinId p = first; p < last; p++ ) {
+
+    const VerParserPinInfo& pin = PinTable[p];
+
+    if ( !is_timed( pin ) || pin.rat_r_late == std::numeric_limits<double>::max() || !is_endpoint( p ) )
+      continue;
+
+    for ( int r = 1; r >= 0; r-- ) {
+
+      PathEntry root;
+      root.parent = INVALID_ID;
+      root.node = INVALID_ID;
+      root.state = state_of( p, r );
+
+      if ( late )
+        root.slack = ( r ? pin.rat_r_late : pin.rat_f_late ) - arrival( pin, r, true );
+      else
+        root.slack = arrival( pin, r, false ) - ( r ? pin.rat_r_early : pin.rat_f_early );
+
+      queue.push( HeapEntry( root.slack, entries.size() ) );
+      entries.push_back( root );
+    }
+  }
+
+  /* Paths found so far, the K best by their slack with the CPPR credit *
+   * of their launch and capture clocks. The worst of them is on top.   */
+  typedef std::pair<double, unsigned int> KeptEntry;   // slack with the credit, slot in found
+  std::priority_queue<KeptEntry> kept;
+  vector<TimingPath> found;
+  TimingPath next;
+
+  if ( K == 0 )
+    return paths;
+
+  /* Every path popped is the next worst without the credit. Its        *
+   * successors are the paths with its last deviation swapped for the   *
+   * next cheaper ones in the heap, and the path with the cheapest      *
+   * deviation after it added. A credit is never negative, so once the  *
+   * queue is no worse than the K-th path kept, no path in it gets in.  */
+  while ( !queue.empty() && ( kept.size() < K || queue.top().first < kept.top().first ) ) {
+
+    unsigned int index = queue.top().second;
+    queue.pop();
+
+    materialize( entries, index, worst, next );
+    next.slack += path_credit( next.pins.front(), next.pins.back() );
+
+    if ( kept.size() < K ) {
+      kept.push( KeptEntry( next.slack, found.size() ) );
+      found.push_back( next );
+    }
+    else if ( next.slack < kept.top().first ) {
+      unsigned int slot = kept.top().second;
+      kept.pop();
+      kept.push( KeptEntry( next.slack, slot ) );
+      found[slot] = next;
+    }
+
+    PathEntry path = entries[index];
+    unsigned int after = path.state;
+
+    if ( path.node != INVALID_ID ) {
+
+      const DeviationNode& node = Deviations[path.node];
+      unsigned int children[2] = { node.left, node.right };
+
+      for ( int c = 0; c < 2; c++ )
+        if ( children[c] != INVALID_ID ) {
+          PathEntry swapped = path;
+          swapped.node = children[c];
+          swapped.slack = path.slack - node.cost + Deviations[children[c]].cost;
+          queue.push( HeapEntry( swapped.slack, entries.size() ) );
+          entries.push_back( swapped );
+        }
+
+      after = node.to;
+    }
+
+    if ( heap[after] != INVALID_ID ) {
+      PathEntry added;
+      added.parent = index;
+      added.node = heap[after];
+      added.state = path.state;
+      added.slack = path.slack + Deviations[heap[after]].cost;
+      queue.push( HeapEntry( added.slack, entries.size() ) );
+      entries.push_back( added );
+    }
+  }
+
+  /* Worst first */
+  vector<unsigned int> order;
+  for ( ; !kept.empty(); kept.pop() )
+    order.push_back( kept.top().second );
+
+  for ( auto it = order.rbegin(); it != order.rend(); it++ )
+    paths.push_back( found[*it] );
+
+  Deviations.clear();
+  Deviations.shrink_to_fit();
+
+  return paths;
+
+}
+
+/* Long paths make for a lot of lines, so only flush at the end */
+void print_paths( const vector<TimingPath>& paths, bool late, std::ostream& out ) {
+
+  for ( unsigned int i = 0; i < paths.size(); i++ ) {
+
+    out << "Path " << i + 1 << ": " << ( late ? "late" : "early" ) << " slack " << paths[i].slack << "\n";
+
+    for ( unsigned int j = 0; j < paths[i].pins.size(); j++ ) {
+      const VerParserPinInfo& pin = PinTable[paths[i].pins[j]];
+      bool rise = paths[i].rise[j];
+      out << "\t" << PinNames.name(paths[i].pins[j]) << ( rise ? " rise " : " fall " ) << arrival( pin, rise, late ) << "\n";
+    }
+  }
+
+  out.flush();
+
+}
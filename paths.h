@@ -0,0 +1,28 @@
+#ifndef _PATHS_H
+#define _PATHS_H
+
+#include "graph.h"
+
+/* A timing path from a start point (primary input or flip flop clock) *
+ * to an endpoint, with the transition at every pin.                   */
+struct TimingPath {
+
+  double slack;
+  vector<PinId> pins;   // start point first
+  vector<bool> rise;    // by position in pins
+
+  TimingPath () : slack (0.0) {}
+
+};
+
+/* The K paths with the worst late (setup) or early (hold) slack, worst *
+ * first. Uses the slack of the last timing pass, with the CPPR credit  *
+ * of the clocks launching and capturing a path. With an endpoint only  *
+ * the paths into it are listed, otherwise the paths of all endpoints.  *
+ * Paths are only materialized once they come off the queue.           */
+vector<TimingPath> report_worst_paths( unsigned int K, bool late = true, PinId endpoint = INVALID_ID );
+
+/* Print paths one pin per line with their arrival times */
+void print_paths( const vector<TimingPath>& paths, bool late, std::ostream& out = cout );
+
+#endif
@@ -0,0 +1,166 @@
+#include <unordered_map>
+#include "rc_tree.h"
+
+static string node_key (const SpefNodeName& n) {
+
+  return n.n2.empty() ? n.n1 : n.n1 + ":" + n.n2 ;
+}
+
+// Ports with direction I and cell pins with direction O drive the net
+static bool is_driver (const SpefConnection& c) {
+
+  return (c.nodeType == 'P') ? c.direction == 'I' : c.direction == 'O' ;
+}
+
+bool build_rc_tree (const SpefNet& net, RcTree& tree) {
+
+  tree.clear() ;
+
+  if (net.connections.empty())
+    return false ;
+
+  // Number the nodes as they are first seen
+  std::unordered_map <string, int> index ;
+  vector<const SpefNodeName*> nodes ;
+  index.reserve (net.capacitances.size() + net.connections.size()) ;
+
+  auto node_index = [&] (const SpefNodeName& n) {
+    auto it = index.emplace (node_key (n), (int) nodes.size()) ;
+    if (it.second)
+      nodes.push_back (&n) ;
+    return it.first->second ;
+  } ;
+
+  int root = -1 ;
+  for (auto it = net.connections.begin(); it != net.connections.end(); ++it) {
+    int n = node_index (it->nodeName) ;
+    if (root < 0 && is_driver (*it))
+      root = n ;
+  }
+
+  if (root < 0)
+    return false ;
+
+  for (auto it = net.capacitances.begin(); it != net.capacitances.end(); ++it)
+    node_index (it->nodeName) ;
+
+  // Undirected adjacency, stored as a list per node
+  vector<int> edgeFrom, edgeTo ;
+  vector<double> edgeRes ;
+  for (auto it = net.resistances.begin(); it != net.resistances.end(); ++it) {
+    edgeFrom.push_back (node_index (it->fromNodeName)) ;
+    edgeTo.push_back (node_index (it->toNodeName)) ;
+    edgeRes.push_back (it->resistance) ;
+  }
+
+  int numNodes = nodes.size() ;
+  vector<int> adjStart (numNodes + 1, 0) ;
+  for (int e=0; e < edgeFrom.size(); ++e) {
+    adjStart[edgeFrom[e] + 1]++ ;
+    adjStart[edgeTo[e] + 1]++ ;
+  }
+  for (int i=0; i < numNodes; ++i)
+    adjStart[i+1] += adjStart[i] ;
+
+  vector<int> adj (adjStart[numNodes]) ;
+  vector<int> fill (adjStart.begin(), adjStart.end() - 1) ;
+  for (int e=0; e < edgeFrom.size(); ++e) {
+    adj[fill[edgeFrom[e]]++] = e ;
+    adj[fill[edgeTo[e]]++] = e ;
+  }
+
+  vector<double> nodeCap (numNodes, 0.0) ;
+  for (auto it = net.capacitances.begin(); it != net.capacitances.end(); ++it)
+    nodeCap[index[node_key (it->nodeName)]] += it->capacitance ;
+
+  // Breadth first from the driver. treeIndex maps node -> position in the tree
+  vector<int> treeIndex (numNodes, -1) ;
+  vector<int> queue ;
+  queue.reserve (numNodes) ;
+  queue.push_back (root) ;
+  treeIndex[root] = 0 ;
+
+  tree.parent.push_back (-1) ;
+  tree.res.push_back (0.0) ;
+
+  // Breadth first, the children of a node are numbered together
+  for (int head=0; head < queue.size(); ++head) {
+
+    int n = queue[head] ;
+    tree.firstChild.push_back (queue.size()) ;
+    for (int a=adjStart[n]; a < adjStart[n+1]; ++a) {
+
+      int e = adj[a] ;
+      int next = (edgeFrom[e] == n) ? edgeTo[e] : edgeFrom[e] ;
+      if (treeIndex[next] >= 0)
+        continue ;
+
+      treeIndex[next] = queue.size() ;
+      queue.push_back (next) ;
+      tree.parent.push_back (treeIndex[n]) ;
+      tree.res.push_back (edgeRes[e]) ;
+    }
+  }
+
+  tree.firstChild.push_back (queue.size()) ;
+
+  tree.cap.resize (queue.size()) ;
+  tree.names.resize (queue.size()) ;
+  for (int i=0; i < queue.size(); ++i) {
+    tree.cap[i] = nodeCap[queue[i]] ;
+    tree.names[i] = nodes[queue[i]] ;
+  }
+
+  for (auto it = net.connections.begin(); it != net.connections.end(); ++it) {
+    int t = treeIndex[index[node_key (it->nodeName)]] ;
+    if (!is_driver (*it) && t >= 0)
+      tree.sinks.push_back (t) ;
+  }
+
+  return true ;
+}
+
+void rc_tree_elmore (const RcTree& tree, vector<double>& delay) {
+
+  int numNodes = tree.parent.size() ;
+
+  // Downstream capacitance, children before parents
+  vector<double> down (tree.cap) ;
+  for (int i=numNodes-1; i > 0; --i)
+    down[tree.parent[i]] += down[i] ;
+
+  delay.assign (numNodes, 0.0) ;
+  for (int i=1; i < numNodes; ++i)
+    delay[i] = delay[tree.parent[i]] + tree.res[i] * down[i] ;
+}
+
+void index_spef_net (SpefNet& net) {
+
+  net.sinkDelays.clear() ;
+
+  RcTree tree ;
+  if (!build_rc_tree (net, tree))
+    return ;
+
+  vector<double> delay ;
+  rc_tree_elmore (tree, delay) ;
+
+  net.sinkDelays.resize (tree.sinks.size()) ;
+  for (int i=0; i < tree.sinks.size(); ++i) {
+    int n = tree.sinks[i] ;
+    net.sinkDelays[i].nodeName = *tree.names[n] ;
+    net.sinkDelays[i].delay = delay[n] ;
+  }
+}
+
+void reduce_spef_net (SpefNet& net) {
+
+  index_spef_net (net) ;
+
+  // Swap with empty vectors so that the memory is really returned
+  vector<SpefConnection>().swap (net.connections) ;
+  vector<SpefCapacitance>().swap (net.capacitances) ;
+  vector<SpefResistance>().swap (net.resistances) ;
+
+  net.isReduced = true ;
+}
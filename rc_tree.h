@@ -0,0 +1,55 @@
+/////////////////////////////////////////////////////////////////////
+//
+// RC tree of a spef net and its Elmore delays.
+//
+// The tree is rooted at the driver of the net and its nodes are
+// numbered breadth first, so a node always comes after its parent.
+// Resistor loops are broken: the first path found to a node wins.
+//
+/////////////////////////////////////////////////////////////////////
+
+#ifndef _RC_TREE_H
+#define _RC_TREE_H
+
+#include "parser_helper.h"
+
+struct RcTree {
+
+  vector<int> parent ;     // parent node, -1 for the root
+  vector<int> firstChild ; // children of n are firstChild[n] .. firstChild[n+1]-1
+  vector<double> res ;     // resistance to the parent
+  vector<double> cap ;     // grounded capacitance of the node
+  vector<const SpefNodeName*> names ;
+
+  // Node of every receiver (cell input pin or primary output port)
+  vector<int> sinks ;
+
+  void clear() {
+    parent.clear() ;
+    firstChild.clear() ;
+    res.clear() ;
+    cap.clear() ;
+    names.clear() ;
+    sinks.clear() ;
+  }
+
+} ;
+
+// Build the tree of the given net. The node names point into the net,
+// so the tree must not outlive it. Returns false for nets without
+// connections or without a driver.
+bool build_rc_tree (const SpefNet& net, RcTree& tree) ;
+
+// Elmore delay (first moment of the impulse response) at every node
+void rc_tree_elmore (const RcTree& tree, vector<double>& delay) ;
+
+// Fill in the per-sink delays of the net from its tree, keeping the RC
+// detail. Every sink comes out of the same two passes over the tree,
+// so this is linear in the size of the net.
+void index_spef_net (SpefNet& net) ;
+
+// Keep only the per-sink delays of the net and free the connections,
+// capacitances and resistances. Used by -spef_stream.
+void reduce_spef_net (SpefNet& net) ;
+
+#endif
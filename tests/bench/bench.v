@@ -0,0 +1,201 @@
+module bench (
+inp0,
+inp1,
+inp2,
+inp3,
+inp4,
+inp5,
+clk,
+n4,
+n8,
+n9,
+n19,
+n20,
+n22,
+n23,
+n33,
+n34,
+n36,
+n41,
+n43,
+n46,
+n47,
+n48,
+n49,
+n51,
+n52,
+n54,
+n55,
+n56,
+n57,
+n58,
+n59
+);
+
+// Start PIs
+input inp0;
+input inp1;
+input inp2;
+input inp3;
+input inp4;
+input inp5;
+input clk;
+
+// Start POs
+output n4;
+output n8;
+output n9;
+output n19;
+output n20;
+output n22;
+output n23;
+output n33;
+output n34;
+output n36;
+output n41;
+output n43;
+output n46;
+output n47;
+output n48;
+output n49;
+output n51;
+output n52;
+output n54;
+output n55;
+output n56;
+output n57;
+output n58;
+output n59;
+
+// Start wires
+wire ck0;
+wire ck1;
+wire ck2;
+wire n0;
+wire n1;
+wire n2;
+wire n3;
+wire n4;
+wire n5;
+wire n6;
+wire n7;
+wire n8;
+wire n9;
+wire n10;
+wire n11;
+wire n12;
+wire n13;
+wire n14;
+wire n15;
+wire n16;
+wire n17;
+wire n18;
+wire n19;
+wire n20;
+wire n21;
+wire n22;
+wire n23;
+wire n24;
+wire n25;
+wire n26;
+wire n27;
+wire n28;
+wire n29;
+wire n30;
+wire n31;
+wire n32;
+wire n33;
+wire n34;
+wire n35;
+wire n36;
+wire n37;
+wire n38;
+wire n39;
+wire n40;
+wire n41;
+wire n42;
+wire n43;
+wire n44;
+wire n45;
+wire n46;
+wire n47;
+wire n48;
+wire n49;
+wire n50;
+wire n51;
+wire n52;
+wire n53;
+wire n54;
+wire n55;
+wire n56;
+wire n57;
+wire n58;
+wire n59;
+
+// Start cells
+BUF_X1 u0 ( .a(inp0), .o(n0) );
+NAND2_X1 u1 ( .a(n0), .b(inp5), .o(n1) );
+XOR2_X1 u2 ( .a(inp1), .b(n0), .o(n2) );
+XOR2_X1 u3 ( .a(inp0), .b(inp4), .o(n3) );
+BUF_X1 u4 ( .a(inp1), .o(n4) );
+DFF_X1 u5 ( .d(inp0), .ck(ck1), .q(n5) );
+INV_X1 u6 ( .a(n2), .o(n6) );
+INV_X1 u7 ( .a(n0), .o(n7) );
+BUF_X1 u8 ( .a(n5), .o(n8) );
+INV_X1 u9 ( .a(n6), .o(n9) );
+XOR2_X1 u10 ( .a(n1), .b(n1), .o(n10) );
+XOR2_X1 u11 ( .a(inp0), .b(inp3), .o(n11) );
+BUF_X1 u12 ( .a(n3), .o(n12) );
+INV_X1 u13 ( .a(n10), .o(n13) );
+XOR2_X1 u14 ( .a(n0), .b(n12), .o(n14) );
+XOR2_X1 u15 ( .a(n10), .b(inp1), .o(n15) );
+XOR2_X1 u16 ( .a(n6), .b(inp5), .o(n16) );
+NAND2_X1 u17 ( .a(n16), .b(n5), .o(n17) );
+INV_X1 u18 ( .a(n10), .o(n18) );
+INV_X1 u19 ( .a(n10), .o(n19) );
+XOR2_X1 u20 ( .a(n17), .b(inp1), .o(n20) );
+NAND2_X1 u21 ( .a(n13), .b(n6), .o(n21) );
+DFF_X1 u22 ( .d(inp5), .ck(ck2), .q(n22) );
+BUF_X1 u23 ( .a(n18), .o(n23) );
+BUF_X1 u24 ( .a(n21), .o(n24) );
+BUF_X1 u25 ( .a(n5), .o(n25) );
+NAND2_X1 u26 ( .a(n11), .b(inp0), .o(n26) );
+XOR2_X1 u27 ( .a(n26), .b(n7), .o(n27) );
+XOR2_X1 u28 ( .a(n24), .b(n6), .o(n28) );
+XOR2_X1 u29 ( .a(n16), .b(inp0), .o(n29) );
+NAND2_X1 u30 ( .a(inp1), .b(n5), .o(n30) );
+BUF_X1 u31 ( .a(n29), .o(n31) );
+NAND2_X1 u32 ( .a(inp4), .b(inp1), .o(n32) );
+XOR2_X1 u33 ( .a(n11), .b(n1), .o(n33) );
+BUF_X1 u34 ( .a(inp4), .o(n34) );
+BUF_X1 u35 ( .a(n28), .o(n35) );
+BUF_X1 u36 ( .a(n14), .o(n36) );
+XOR2_X1 u37 ( .a(n28), .b(inp4), .o(n37) );
+NAND2_X1 u38 ( .a(n24), .b(n14), .o(n38) );
+DFF_X1 u39 ( .d(n31), .ck(ck1), .q(n39) );
+BUF_X1 u40 ( .a(n21), .o(n40) );
+INV_X1 u41 ( .a(n26), .o(n41) );
+BUF_X1 u42 ( .a(n12), .o(n42) );
+XOR2_X1 u43 ( .a(n30), .b(n17), .o(n43) );
+XOR2_X1 u44 ( .a(n5), .b(n40), .o(n44) );
+NAND2_X1 u45 ( .a(n32), .b(n24), .o(n45) );
+BUF_X1 u46 ( .a(inp3), .o(n46) );
+NAND2_X1 u47 ( .a(n11), .b(n26), .o(n47) );
+BUF_X1 u48 ( .a(n24), .o(n48) );
+BUF_X1 u49 ( .a(n11), .o(n49) );
+BUF_X1 u50 ( .a(n30), .o(n50) );
+XOR2_X1 u51 ( .a(n50), .b(n35), .o(n51) );
+BUF_X1 u52 ( .a(n25), .o(n52) );
+XOR2_X1 u53 ( .a(n44), .b(n37), .o(n53) );
+NAND2_X1 u54 ( .a(n15), .b(n39), .o(n54) );
+NAND2_X1 u55 ( .a(n27), .b(n45), .o(n55) );
+DFF_X1 u56 ( .d(n44), .ck(ck2), .q(n56) );
+BUF_X1 u57 ( .a(n30), .o(n57) );
+NAND2_X1 u58 ( .a(n42), .b(n38), .o(n58) );
+XOR2_X1 u59 ( .a(n53), .b(n21), .o(n59) );
+
+BUF_X1 cb0 ( .a(clk), .o(ck0) );
+BUF_X1 cb1 ( .a(ck0), .o(ck1) );
+BUF_X1 cb2 ( .a(ck0), .o(ck2) );
+
+endmodule
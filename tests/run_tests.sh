@@ -0,0 +1,47 @@
+#!/bin/bash
+# Run every .ops file under tests/ on the design in its directory and
+# compare the answers with the .expected file of the same name. Each one
+# runs on one thread and on several, with and without -lazy and with and
+# without -delay_cache. None of these may change a reported value.
+
+cd "$(dirname "$0")/.." || exit 1
+
+EXECUTABLE="$PWD/chronosphere"
+THREADS=4
+OUTPUT=$(mktemp) || exit 1
+trap 'rm -f "$OUTPUT"' EXIT
+
+failed=0
+runs=0
+
+for ops in tests/*/*.ops; do
+
+  # The lib parser needs absolute paths
+  dir="$PWD/$(dirname "$ops")"
+  expected="${ops%.ops}.expected"
+
+  for threads in 1 $THREADS; do
+    for lazy in "" "-lazy"; do
+      for cache in "" "-delay_cache 0 0"; do
+
+        options="-threads $threads $lazy $cache"
+        runs=$((runs + 1))
+
+        "$EXECUTABLE" $options "$dir"/*.tau2015 "$dir"/*.timing "$PWD/$ops" "$OUTPUT" > /dev/null 2>&1
+        status=$?
+
+        if [ $status -ne 0 ]; then
+          echo "FAIL $ops $options: exit status $status"
+          failed=$((failed + 1))
+        elif ! cmp -s "$OUTPUT" "$expected"; then
+          echo "FAIL $ops $options: output differs from $expected"
+          diff "$expected" "$OUTPUT" | head -10
+          failed=$((failed + 1))
+        fi
+      done
+    done
+  done
+done
+
+echo "$((runs - failed)) of $runs runs passed."
+[ $failed -eq 0 ]
@@ -0,0 +1,200 @@
+#include <algorithm>
+#include "thread_pool.h"
+
+unsigned int NumThreads = std::max( 1u, std::thread::hardware_concurrency() );
+
+ThreadPool::ThreadPool( unsigned int numThreads ) : job (nullptr), jobSize (0), jobGrain (1), nextIndex (0),
+                                                    graphJob (nullptr), tasksLeft (0), busyWorkers (0),
+                                                    generation (0), stopping (false) {
+
+  deques.resize( std::max( numThreads, 1u ) );
+
+  for ( unsigned int i = 1; i < numThreads; i++ )
+    workers.emplace_back( &ThreadPool::worker_loop, this, i );
+
+}
+
+ThreadPool::~ThreadPool() {
+
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    stopping = true;
+  }
+  wake.notify_all();
+
+  for ( auto it = workers.begin(); it != workers.end(); it++ )
+    it->join();
+
+}
+
+/* Grab chunks of the current job until there are none left */
+void ThreadPool::run_chunks() {
+
+  while ( true ) {
+
+    size_t begin = nextIndex.fetch_add( jobGrain );
+    if ( begin >= jobSize )
+      break;
+
+    size_t end = std::min( begin + jobGrain, jobSize );
+    for ( size_t i = begin; i < end; i++ )
+      (*job)(i);
+  }
+
+}
+
+/* Own deque first, newest task first. Then steal the oldest task of *
+ * the next thread that has one.                                      */
+bool ThreadPool::next_task( unsigned int self, uint32_t& task ) {
+
+  {
+    TaskDeque& own = deques[self];
+    std::lock_guard<std::mutex> guard(own.lock);
+    if ( !own.tasks.empty() ) {
+      task = own.tasks.back();
+      own.tasks.pop_back();
+      return true;
+    }
+  }
+
+  for ( unsigned int i = 1; i < deques.size(); i++ ) {
+
+    TaskDeque& victim = deques[( self + i ) % deques.size()];
+    std::lock_guard<std::mutex> guard(victim.lock);
+
+    if ( !victim.tasks.empty() ) {
+      task = victim.tasks.front();
+      victim.tasks.pop_front();
+      return true;
+    }
+  }
+
+  return false;
+
+}
+
+/* Run and steal tasks of the current graph until all of them are done. *
+ * A thread with nothing to take waits for the running tasks to make     *
+ * some ready.                                                           */
+void ThreadPool::run_tasks( unsigned int self ) {
+
+  std::vector<uint32_t> ready;
+  uint32_t task;
+
+  while ( tasksLeft.load( std::memory_order_acquire ) > 0 ) {
+
+    if ( !next_task( self, task ) ) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    ready.clear();
+    (*graphJob)( task, ready );
+
+    if ( !ready.empty() ) {
+      TaskDeque& own = deques[self];
+      std::lock_guard<std::mutex> guard(own.lock);
+      own.tasks.insert( own.tasks.end(), ready.begin(), ready.end() );
+    }
+
+    tasksLeft.fetch_sub( 1, std::memory_order_acq_rel );
+  }
+
+}
+
+void ThreadPool::worker_loop( unsigned int self ) {
+
+  unsigned long seen = 0;
+
+  while ( true ) {
+
+    {
+      std::unique_lock<std::mutex> guard(lock);
+      wake.wait( guard, [&] { return stopping || generation != seen; } );
+
+      if ( stopping )
+        return;
+
+      seen = generation;
+    }
+
+    if ( graphJob != nullptr )
+      run_tasks( self );
+    else
+      run_chunks();
+
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      if ( --busyWorkers == 0 )
+        done.notify_one();
+    }
+  }
+
+}
+
+void ThreadPool::parallel_for( size_t count, const std::function<void(size_t)>& func, size_t grain ) {
+
+  if ( count == 0 )
+    return;
+
+  /* Not worth waking anyone up */
+  if ( workers.empty() || count <= grain ) {
+    for ( size_t i = 0; i < count; i++ )
+      func(i);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    job = &func;
+    jobSize = count;
+    jobGrain = std::max( grain, (size_t)1 );
+    nextIndex = 0;
+    busyWorkers = workers.size();
+    generation++;
+  }
+  wake.notify_all();
+
+  run_chunks();
+
+  std::unique_lock<std::mutex> guard(lock);
+  done.wait( guard, [&] { return busyWorkers == 0; } );
+  job = nullptr;
+
+}
+
+void ThreadPool::run_graph( const std::vector<uint32_t>& roots, size_t count, const GraphTask& func ) {
+
+  if ( count == 0 )
+    return;
+
+  /* Spread the roots so that every thread starts with work */
+  for ( size_t i = 0; i < roots.size(); i++ )
+    deques[i % deques.size()].tasks.push_back( roots[i] );
+
+  tasksLeft = count;
+  graphJob = &func;
+
+  if ( !workers.empty() ) {
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      busyWorkers = workers.size();
+      generation++;
+    }
+    wake.notify_all();
+  }
+
+  run_tasks( 0 );
+
+  std::unique_lock<std::mutex> guard(lock);
+  done.wait( guard, [&] { return busyWorkers == 0; } );
+  graphJob = nullptr;
+
+}
+
+ThreadPool& thread_pool() {
+
+  static ThreadPool pool( NumThreads );
+  return pool;
+
+}
@@ -0,0 +1,76 @@
+#ifndef _THREAD_POOL_H
+#define _THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+/* Number of worker threads. Set from the command line (-threads), *
+ * defaults to the number of hardware threads.                     */
+extern unsigned int NumThreads;
+
+/* Task with the tasks it made ready appended to the vector */
+typedef std::function<void(uint32_t, std::vector<uint32_t>&)> GraphTask;
+
+/* Fixed size pool of worker threads. The calling thread takes part *
+ * in every job, so a pool of N threads runs N - 1 workers.         */
+class ThreadPool {
+
+  /* Ready tasks of one thread. The owner takes from the back, the *
+   * others steal from the front.                                  */
+  struct TaskDeque {
+    std::mutex lock;
+    std::deque<uint32_t> tasks;
+  };
+
+  std::vector<std::thread> workers;
+  std::mutex lock;
+  std::condition_variable wake;
+  std::condition_variable done;
+
+  /* Current job, either a parallel_for or a run_graph */
+  const std::function<void(size_t)>* job;
+  size_t jobSize;
+  size_t jobGrain;
+  std::atomic<size_t> nextIndex;
+  const GraphTask* graphJob;
+  std::deque<TaskDeque> deques;     // by thread, the caller is 0
+  std::atomic<size_t> tasksLeft;
+  unsigned int busyWorkers;
+  unsigned long generation;
+  bool stopping;
+
+  void worker_loop( unsigned int self );
+  void run_chunks();
+  bool next_task( unsigned int self, uint32_t& task );
+  void run_tasks( unsigned int self );
+
+public:
+
+  ThreadPool( unsigned int numThreads );
+  ~ThreadPool();
+
+  unsigned int size() const { return workers.size() + 1; }
+
+  /* Call func(i) for every i in [0, count). Iterations are handed out *
+   * in chunks of grain. Returns when all of them have finished.       */
+  void parallel_for( size_t count, const std::function<void(size_t)>& func, size_t grain = 1 );
+
+  /* Run a graph of count tasks without barriers. roots are the tasks *
+   * ready from the start; every other task must be made ready by     *
+   * exactly one call of func, which runs a task and appends the ones *
+   * it made ready. They go to the deque of the thread that ran it.   *
+   * Returns when all count tasks have run.                           */
+  void run_graph( const std::vector<uint32_t>& roots, size_t count, const GraphTask& func );
+
+};
+
+/* Shared pool, created on first use with NumThreads threads */
+ThreadPool& thread_pool();
+
+#endif